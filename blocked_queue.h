@@ -0,0 +1,170 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Blocked queue engines. A process that enters IO is parked here until its
+// absolute wake time; processes that wake at the same time leave in the order
+// they were blocked (FIFO on ties). Both engines expose the same interface so
+// Simulation can be instantiated with either:
+//   push(proc, wake_time)  park a process
+//   empty(), size()
+//   next_wake()            earliest wake time (queue must not be empty)
+//   pop_due(now, f)        call f(proc) for every process with wake_time <= now,
+//                          earliest first, FIFO on ties
+
+#ifndef BLOCKED_QUEUE_H
+#define BLOCKED_QUEUE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Binary min-heap keyed by (wake_time, order). O(log n) per push and per wake up.
+class HeapBlockedQueue {
+public:
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    void push(uint32_t proc, int wake_time) {
+        heap.push_back(Item{proc, wake_time, order_counter++});
+        std::push_heap(heap.begin(), heap.end(), Later());
+    }
+
+    int next_wake() const { return heap.front().wake_time; }
+
+    template <typename F>
+    void pop_due(int now, F&& f) {
+        while (!heap.empty() && heap.front().wake_time <= now) {
+            std::pop_heap(heap.begin(), heap.end(), Later());
+            uint32_t proc = heap.back().proc;
+            heap.pop_back();
+            f(proc);
+        }
+    }
+
+private:
+    struct Item { uint32_t proc; int wake_time; uint64_t order; }; // Order for stability on equal wake times
+
+    // Heap comparator: earliest absolute wake time on top, FIFO (lowest order) on ties
+    struct Later {
+        bool operator()(const Item& a, const Item& b) const {
+            if (a.wake_time != b.wake_time) return a.wake_time > b.wake_time;
+            return a.order > b.order;
+        }
+    };
+
+    std::vector<Item> heap;
+    uint64_t order_counter{0};
+};
+
+// Hierarchical timing wheel: kLevels wheels of kSlots slots each, level l covering
+// bits [l * kBits, (l + 1) * kBits) of the wake time. An item lives on the level of
+// the highest bit group in which its wake time differs from the wheel's cursor, so
+// level 0 slots hold exact wake times and higher levels hold ranges that cascade
+// down once the cursor reaches them. Push is O(1); every item cascades at most
+// kLevels - 1 times, so expiry is O(1) amortized. Occupancy bitmaps make finding
+// the next non-empty slot a count-trailing-zeros instead of a tick-by-tick scan,
+// which lets the clock jump arbitrarily far.
+class TimingWheelBlockedQueue {
+public:
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void push(uint32_t proc, int wake_time) {
+        place(Item{proc, (uint32_t)wake_time, order_counter++});
+        ++count;
+    }
+
+    int next_wake() const {
+        uint64_t m0 = occupied[0] & (~0ULL << (cursor & kMask));
+        if (m0) return (int)((cursor & ~(uint32_t)kMask) | (uint32_t)__builtin_ctzll(m0));
+        // The earliest item sits in the first occupied slot of the lowest occupied level
+        for (int lvl = 1; lvl < kLevels; ++lvl) {
+            uint64_t m = occupied[lvl] & (~0ULL << slot_index(cursor, lvl));
+            if (!m) continue;
+            const std::vector<Item>& slot = slots[lvl][__builtin_ctzll(m)];
+            uint32_t best = slot.front().wake_time;
+            for (const Item& it : slot) best = std::min(best, it.wake_time);
+            return (int)best;
+        }
+        return 0;
+    }
+
+    template <typename F>
+    void pop_due(int now, F&& f) {
+        uint32_t target = (uint32_t)now;
+        while (count > 0) {
+            uint64_t m0 = occupied[0] & (~0ULL << (cursor & kMask));
+            if (m0) {
+                int idx = __builtin_ctzll(m0);
+                uint32_t wake = (cursor & ~(uint32_t)kMask) | (uint32_t)idx;
+                if (wake > target) break;
+                cursor = wake;
+                expire(idx, f);
+                continue;
+            }
+            int lvl = 1, idx = 0;
+            for (; lvl < kLevels; ++lvl) {
+                uint64_t m = occupied[lvl] & (~0ULL << slot_index(cursor, lvl));
+                if (m) { idx = __builtin_ctzll(m); break; }
+            }
+            if (lvl == kLevels) break;
+            uint64_t span = (1ULL << ((lvl + 1) * kBits)) - 1;
+            uint32_t base = (uint32_t)((cursor & ~span) | ((uint64_t)idx << (lvl * kBits)));
+            if (base > target) break;
+            cursor = base;
+            cascade(lvl, idx);
+        }
+        // Nothing is due before now, so every remaining item stays valid relative to it
+        if (target > cursor) cursor = target;
+    }
+
+private:
+    static constexpr int kBits = 6;
+    static constexpr int kSlots = 1 << kBits;
+    static constexpr uint32_t kMask = kSlots - 1;
+    static constexpr int kLevels = 6; // 36 bits, enough for any non-negative int wake time
+
+    struct Item { uint32_t proc; uint32_t wake_time; uint64_t order; };
+
+    static int slot_index(uint32_t t, int lvl) { return (int)((t >> (lvl * kBits)) & kMask); }
+
+    void place(const Item& it) {
+        uint32_t diff = it.wake_time ^ cursor;
+        int lvl = diff ? (31 - __builtin_clz(diff)) / kBits : 0;
+        int idx = slot_index(it.wake_time, lvl);
+        slots[lvl][idx].push_back(it);
+        occupied[lvl] |= 1ULL << idx;
+    }
+
+    void cascade(int lvl, int idx) {
+        scratch.swap(slots[lvl][idx]);
+        occupied[lvl] &= ~(1ULL << idx);
+        for (const Item& it : scratch) place(it);
+        scratch.clear();
+    }
+
+    // Every item in a level 0 slot has the same wake time; cascaded items may have
+    // arrived after items that were blocked later, so restore FIFO order first
+    template <typename F>
+    void expire(int idx, F& f) {
+        scratch.swap(slots[0][idx]);
+        occupied[0] &= ~(1ULL << idx);
+        auto by_order = [](const Item& a, const Item& b) { return a.order < b.order; };
+        if (!std::is_sorted(scratch.begin(), scratch.end(), by_order)) {
+            std::sort(scratch.begin(), scratch.end(), by_order);
+        }
+        count -= scratch.size();
+        for (const Item& it : scratch) f(it.proc);
+        scratch.clear();
+    }
+
+    std::vector<Item> slots[kLevels][kSlots];
+    uint64_t occupied[kLevels] = {};
+    std::vector<Item> scratch;
+    uint32_t cursor{0};
+    size_t count{0};
+    uint64_t order_counter{0};
+};
+
+#endif
@@ -0,0 +1,515 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+
+#include "bursts.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <immintrin.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+// Whitespace that separates bursts within a line (isspace in the C locale minus '\n')
+static inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool is_digit(char c) { return (unsigned char)(c - '0') < 10; }
+
+// One line, without its '\n'
+static BurstError parse_line(const char* p, const char* eol, BurstArena& arena) {
+    size_t start = arena.bursts.size();
+    while (true) {
+        while (p < eol && is_blank(*p)) ++p;
+        if (p == eol) break;
+        bool negative = false;
+        if (*p == '+' || *p == '-') { negative = (*p == '-'); ++p; }
+        if (p == eol || !is_digit(*p)) break; // not a number, the rest of the line is ignored
+        // Largest magnitude that still fits an int; anything above fails extraction
+        const uint64_t limit = negative ? 2147483648ULL : 2147483647ULL;
+        uint64_t v = 0;
+        while (p < eol && is_digit(*p) && v <= limit) v = v * 10 + (uint64_t)(*p++ - '0');
+        if (v > limit) break;
+        if (negative || v == 0) return BurstError::NON_POSITIVE;
+        arena.bursts.push_back((int)v);
+    }
+    size_t count = arena.bursts.size() - start;
+    if (count == 0) return BurstError::NONE;
+    if (count % 2 == 0) return BurstError::EVEN_COUNT;
+    arena.end_line();
+    return BurstError::NONE;
+}
+
+static BurstError parse_scalar(const char* begin, const char* end, BurstArena& arena) {
+    const char* p = begin;
+    while (p < end) {
+        const char* eol = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+        if (!eol) eol = end;
+        BurstError err = parse_line(p, eol, arena);
+        if (err != BurstError::NONE) return err;
+        if (eol == end) break;
+        p = eol + 1;
+    }
+    return BurstError::NONE;
+}
+
+// -- Vector scanning --
+// A classifier turns 32 bytes into bitmasks, bit i describing byte i.
+struct BlockMasks { uint32_t digit, blank, newline; };
+
+struct ClassifyAvx2 {
+    __attribute__((target("avx2"))) BlockMasks operator()(const char* p) const {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        // Bytes >= 0x80 compare as negative, so they are never digits or whitespace
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        __m256i ctrl = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+                                        _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v));
+        __m256i space = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+        __m256i newline = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+        BlockMasks m;
+        m.digit = (uint32_t)_mm256_movemask_epi8(digit);
+        m.newline = (uint32_t)_mm256_movemask_epi8(newline);
+        m.blank = (uint32_t)_mm256_movemask_epi8(space) & ~m.newline;
+        return m;
+    }
+};
+
+struct ClassifySse42 {
+    __attribute__((target("sse4.2"))) static void half(const char* p, uint32_t& digit, uint32_t& blank, uint32_t& newline) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i d = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+        __m128i space = _mm_or_si128(ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+        __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+        digit = (uint32_t)_mm_movemask_epi8(d);
+        newline = (uint32_t)_mm_movemask_epi8(nl);
+        blank = (uint32_t)_mm_movemask_epi8(space) & ~newline;
+    }
+
+    __attribute__((target("sse4.2"))) BlockMasks operator()(const char* p) const {
+        uint32_t d0, b0, n0, d1, b1, n1;
+        half(p, d0, b0, n0);
+        half(p + 16, d1, b1, n1);
+        return BlockMasks{d0 | (d1 << 16), b0 | (b1 << 16), n0 | (n1 << 16)};
+    }
+};
+
+static const uint64_t kPow10[11] = {1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+                                    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL};
+
+// Digit run to integer, a fixed-length multiply-add with no branch on the bytes
+static inline uint64_t run_value(const char* p, int len) {
+    uint64_t v = 0;
+    for (int i = 0; i < len; ++i) v = v * 10 + (uint64_t)(p[i] - '0');
+    return v;
+}
+
+// Scans 32-byte blocks made only of digits, blanks and newlines using the masks:
+// run ends and newlines are visited in order with count-trailing-zeros, run starts
+// are recovered from the start mask. A number may continue into the next block.
+// Anything the fast path does not handle (signs, stray characters, more than 10
+// digits, values past INT_MAX, the short tail of the buffer) sends the current
+// line back to parse_line, which rescans it from its first byte.
+template <typename Classify>
+static inline __attribute__((always_inline)) BurstError parse_blocks(const char* begin, const char* end, BurstArena& arena) {
+    Classify classify;
+    std::vector<int>& out = arena.bursts;
+    size_t n = out.size();                  // bursts written; out is kept ahead of n, trimmed on exit
+    const char* p = begin;
+    const char* line_begin = begin;         // first byte of the current line
+    size_t line_start = n;                  // n when the current line began
+    uint64_t carry = 0;                     // digits of a number still open at the end of the last block
+    int carry_len = 0;
+
+    // Redo the current line, and any line reaching into [p, block_end), with the scalar scanner
+    auto fall_back = [&](const char* block_end) -> BurstError {
+        out.resize(line_start);
+        carry = 0; carry_len = 0;
+        while (line_begin < block_end) {
+            const char* eol = static_cast<const char*>(std::memchr(line_begin, '\n', (size_t)(end - line_begin)));
+            if (!eol) eol = end;
+            BurstError err = parse_line(line_begin, eol, arena);
+            if (err != BurstError::NONE) return err;
+            line_begin = (eol == end) ? end : eol + 1;
+        }
+        n = line_start = out.size();
+        p = line_begin;
+        return BurstError::NONE;
+    };
+
+    BurstError err = BurstError::NONE;
+    while (end - p >= 32) {
+        BlockMasks m = classify(p);
+        if ((m.digit | m.blank | m.newline) != 0xFFFFFFFFu) {
+            if ((err = fall_back(p + 32)) != BurstError::NONE) return err;
+            continue;
+        }
+        // A block holds at most 17 numbers (16 plus one carried in)
+        if (out.size() < n + 17) out.resize(std::max(n + 17, out.size() * 2));
+        uint32_t starts = m.digit & ~(m.digit << 1);
+        if (carry_len) {
+            if (m.digit & 1u) {
+                starts &= ~1u; // byte 0 continues the open number
+            } else {
+                if (carry > 2147483647ULL) {
+                    if ((err = fall_back(p + 32)) != BurstError::NONE) return err;
+                    continue;
+                }
+                if (carry == 0) { err = BurstError::NON_POSITIVE; break; }
+                out[n++] = (int)carry;
+                carry = 0; carry_len = 0;
+            }
+        }
+        uint32_t ends = m.digit & ~(m.digit >> 1) & 0x7FFFFFFFu; // bit 31 digits stay open
+        uint32_t events = ends | m.newline;
+        bool redo = false;
+        while (events) {
+            int e = __builtin_ctz(events);
+            uint32_t bit = 1u << e;
+            events &= events - 1;
+            if (m.newline & bit) {
+                size_t count = n - line_start;
+                if (count % 2 == 0 && count != 0) { err = BurstError::EVEN_COUNT; break; }
+                if (count) arena.offsets.push_back(n);
+                line_begin = p + e + 1;
+                line_start = n;
+                continue;
+            }
+            // The run ending at e starts at the last start bit at or below e, or carried in
+            uint32_t before = starts & (bit | (bit - 1));
+            int s = before ? 31 - __builtin_clz(before) : 0;
+            int len = e - s + 1;
+            int total = (before ? 0 : carry_len) + len;
+            if (total > 10) { redo = true; break; }
+            uint64_t v = (before ? 0 : carry) * kPow10[len] + run_value(p + s, len);
+            carry = 0; carry_len = 0;
+            if (v > 2147483647ULL) { redo = true; break; }
+            if (v == 0) { err = BurstError::NON_POSITIVE; break; }
+            out[n++] = (int)v;
+        }
+        if (err != BurstError::NONE) break;
+        if (!redo && (m.digit >> 31)) {
+            int s = starts ? 31 - __builtin_clz(starts) : 0;
+            int len = 32 - s;
+            if (starts) { carry = 0; carry_len = 0; }
+            carry_len += len;
+            if (carry_len > 10) redo = true;
+            else carry = carry * kPow10[len] + run_value(p + s, len);
+        }
+        if (redo) {
+            if ((err = fall_back(p + 32)) != BurstError::NONE) return err;
+            continue;
+        }
+        p += 32;
+    }
+    if (err != BurstError::NONE) {
+        out.resize(n);
+        return err;
+    }
+    // Short tail: finish the current line and whatever follows with the scalar scanner
+    out.resize(line_start);
+    return parse_scalar(line_begin, end, arena);
+}
+
+__attribute__((target("avx2"), flatten)) static BurstError parse_avx2(const char* begin, const char* end, BurstArena& arena) {
+    return parse_blocks<ClassifyAvx2>(begin, end, arena);
+}
+
+__attribute__((target("sse4.2"), flatten)) static BurstError parse_sse42(const char* begin, const char* end, BurstArena& arena) {
+    return parse_blocks<ClassifySse42>(begin, end, arena);
+}
+
+ScanIsa best_scan_isa() {
+    static const ScanIsa isa = __builtin_cpu_supports("avx2")   ? ScanIsa::AVX2
+                             : __builtin_cpu_supports("sse4.2") ? ScanIsa::SSE42
+                                                                : ScanIsa::SCALAR;
+    return isa;
+}
+
+BurstError parse_bursts(const char* begin, const char* end, BurstArena& arena, ScanIsa isa) {
+    switch (isa) {
+        case ScanIsa::AVX2: return parse_avx2(begin, end, arena);
+        case ScanIsa::SSE42: return parse_sse42(begin, end, arena);
+        case ScanIsa::SCALAR: break;
+    }
+    return parse_scalar(begin, end, arena);
+}
+
+BurstError parse_bursts(const char* begin, const char* end, BurstArena& arena) {
+    return parse_bursts(begin, end, arena, best_scan_isa());
+}
+
+FileView::~FileView() {
+    if (map != MAP_FAILED) munmap(map, len);
+    if (fd >= 0) close(fd);
+}
+
+bool FileView::open(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        len = (size_t)st.st_size;
+        if (len == 0) return true;
+        map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            madvise(map, len, MADV_SEQUENTIAL);
+            return true;
+        }
+    }
+    char buf[1 << 16];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof buf)) > 0) copy.insert(copy.end(), buf, buf + n);
+    len = copy.size();
+    return true;
+}
+
+const char* FileView::data() const { return map != MAP_FAILED ? static_cast<const char*>(map) : copy.data(); }
+
+void FileView::release(size_t upto) {
+    if (map == MAP_FAILED) return;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    upto -= upto % page;
+    // Clean pages of a read-only mapping, so they are simply read again if touched
+    if (upto) madvise(map, upto, MADV_DONTNEED);
+}
+
+// -- Parallel parsing --
+// Below this size thread start-up costs more than it saves
+static const size_t kParallelMinBytes = 4u << 20;
+
+BurstError parse_bursts_parallel(const char* begin, const char* end, BurstArena& arena, unsigned threads) {
+    if (threads <= 1) return parse_bursts(begin, end, arena);
+
+    // Chunk boundaries sit just after a '\n', so every chunk holds whole lines
+    std::vector<const char*> cuts{begin};
+    size_t total = (size_t)(end - begin);
+    for (unsigned i = 1; i < threads; ++i) {
+        const char* target = std::max(begin + total / threads * i, cuts.back());
+        const char* nl = static_cast<const char*>(std::memchr(target, '\n', (size_t)(end - target)));
+        cuts.push_back(nl ? nl + 1 : end);
+    }
+    cuts.push_back(end);
+
+    size_t chunks = cuts.size() - 1;
+    std::vector<BurstArena> parts(chunks);
+    std::vector<BurstError> errors(chunks, BurstError::NONE);
+    std::vector<std::thread> pool;
+    for (size_t i = 0; i < chunks; ++i) {
+        pool.emplace_back([&, i] { errors[i] = parse_bursts(cuts[i], cuts[i + 1], parts[i]); });
+    }
+    for (auto& t : pool) t.join();
+    pool.clear();
+
+    // A chunk stops at its own first error, so the earliest failing chunk holds the
+    // first invalid line of the file
+    for (BurstError err : errors) {
+        if (err != BurstError::NONE) return err;
+    }
+
+    // Stitch: every chunk copies its bursts and rebased offsets into place
+    std::vector<size_t> burst_base(chunks + 1, arena.bursts.size());
+    std::vector<size_t> line_base(chunks + 1, arena.offsets.size());
+    for (size_t i = 0; i < chunks; ++i) {
+        burst_base[i + 1] = burst_base[i] + parts[i].bursts.size();
+        line_base[i + 1] = line_base[i] + parts[i].size();
+    }
+    arena.bursts.resize(burst_base[chunks]);
+    arena.offsets.resize(line_base[chunks]);
+    for (size_t i = 0; i < chunks; ++i) {
+        pool.emplace_back([&, i] {
+            const BurstArena& part = parts[i];
+            std::copy(part.bursts.begin(), part.bursts.end(), arena.bursts.begin() + burst_base[i]);
+            size_t shift = burst_base[i];
+            std::transform(part.offsets.begin() + 1, part.offsets.end(), arena.offsets.begin() + line_base[i],
+                           [shift](size_t off) { return off + shift; });
+            std::vector<int>().swap(parts[i].bursts);
+        });
+    }
+    for (auto& t : pool) t.join();
+    return BurstError::NONE;
+}
+
+// threads 0 picks one per core for a file large enough to be worth splitting
+static BurstError parse_view(const FileView& view, BurstArena& arena, unsigned threads = 0) {
+    if (threads == 0) threads = view.size() >= kParallelMinBytes ? std::thread::hardware_concurrency() : 1;
+    return parse_bursts_parallel(view.data(), view.data() + view.size(), arena, threads);
+}
+
+BurstError load_bursts(const std::string& path, BurstArena& arena) {
+    FileView view;
+    if (!view.open(path)) return BurstError::OPEN_FAILED;
+    return parse_view(view, arena);
+}
+
+// -- Binary traces --
+static const char kBinaryMagic[8] = {'S', 'C', 'H', 'B', 'R', 'S', 'T', '1'};
+
+struct BinaryHeader {
+    char magic[8];
+    uint64_t process_count;
+    uint64_t burst_count;
+    uint64_t reserved;
+};
+static_assert(sizeof(BinaryHeader) == 32, "binary trace header must be packed");
+static_assert(sizeof(size_t) == sizeof(uint64_t), "offsets are mapped in place as size_t");
+
+BurstFile::BurstFile() = default;
+BurstFile::~BurstFile() = default;
+
+BurstError BurstFile::open(const std::string& path) { return open(path, 0); }
+
+BurstError BurstFile::open(const std::string& path, unsigned threads) {
+    std::unique_ptr<FileView> view(new FileView);
+    if (!view -> open(path)) return BurstError::OPEN_FAILED;
+    if (view -> size() < sizeof kBinaryMagic || std::memcmp(view -> data(), kBinaryMagic, sizeof kBinaryMagic) != 0) {
+        BurstError err = parse_view(*view, arena, threads);
+        lines = arena.span();
+        return err;
+    }
+    // The layout must fit the file
+    size_t size = view -> size();
+    if (size < sizeof(BinaryHeader)) return BurstError::BAD_BINARY;
+    BinaryHeader h;
+    std::memcpy(&h, view -> data(), sizeof h);
+    size_t room = size - sizeof h;
+    if (h.process_count >= room / sizeof(uint64_t)) return BurstError::BAD_BINARY;
+    room -= (h.process_count + 1) * sizeof(uint64_t);
+    if (h.burst_count > room / sizeof(int32_t)) return BurstError::BAD_BINARY;
+    const size_t* offsets = reinterpret_cast<const size_t*>(view -> data() + sizeof h);
+    if (offsets[0] != 0 || offsets[h.process_count] != h.burst_count) return BurstError::BAD_BINARY;
+    const int* bursts = reinterpret_cast<const int*>(offsets + h.process_count + 1);
+    // and the contents follow the rules of a text file, since the file may have been
+    // edited or cut short since it was written: one pass, in file order
+    for (size_t i = 0; i < h.process_count; ++i) {
+        if (offsets[i + 1] <= offsets[i] || offsets[i + 1] > h.burst_count) return BurstError::BAD_BINARY;
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+            if (bursts[j] <= 0) return BurstError::NON_POSITIVE;
+        }
+        if ((offsets[i + 1] - offsets[i]) % 2 == 0) return BurstError::EVEN_COUNT;
+    }
+    lines = BurstSpan{bursts, offsets, (size_t)h.process_count};
+    mapped = std::move(view);
+    return BurstError::NONE;
+}
+
+bool is_binary_burst_file(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    char magic[sizeof kBinaryMagic];
+    bool binary = read(fd, magic, sizeof magic) == (ssize_t)sizeof magic &&
+                  std::memcmp(magic, kBinaryMagic, sizeof magic) == 0;
+    close(fd);
+    return binary;
+}
+
+bool save_bursts_binary(const std::string& path, const BurstSpan& lines) {
+    FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) return false;
+    BinaryHeader h;
+    std::memcpy(h.magic, kBinaryMagic, sizeof h.magic);
+    h.process_count = lines.size();
+    h.burst_count = lines.size() ? lines.offsets[lines.size()] : 0;
+    h.reserved = 0;
+    static const size_t kNoLines[1] = {0};
+    const size_t* offsets = lines.size() ? lines.offsets : kNoLines;
+    bool ok = std::fwrite(&h, sizeof h, 1, out) == 1 &&
+              std::fwrite(offsets, sizeof(size_t), lines.size() + 1, out) == lines.size() + 1 &&
+              std::fwrite(lines.bursts, sizeof(int), h.burst_count, out) == h.burst_count;
+    return (std::fclose(out) == 0) && ok;
+}
+
+// -- Streaming --
+static const size_t kStreamChunkBytes = 1u << 20;
+static const size_t kStreamMaxQueued = 4;
+
+struct BurstStream::State {
+    FileView view;
+    std::mutex mu;
+    std::condition_variable ready_cv;  // a chunk was queued or parsing ended
+    std::condition_variable space_cv;  // the consumer took a chunk
+    std::deque<std::pair<BurstArena, size_t>> queue; // chunk, file offset it ends at
+    size_t delivered{0};               // consumer side only
+    bool finished{false};
+    bool cancelled{false};             // the consumer went away
+    BurstError status{BurstError::NONE};
+    std::thread parser;
+
+    void produce() {
+        const char* p = view.data();
+        const char* end = p + view.size();
+        BurstError err = BurstError::NONE;
+        while (p < end && err == BurstError::NONE) {
+            const char* cut = p + std::min(kStreamChunkBytes, (size_t)(end - p));
+            const char* nl = static_cast<const char*>(std::memchr(cut, '\n', (size_t)(end - cut)));
+            const char* chunk_end = (cut == end || !nl) ? end : nl + 1;
+            BurstArena part;
+            err = parse_bursts(p, chunk_end, part);
+            p = chunk_end;
+            // Keep only the text still to be parsed in memory
+            view.release((size_t)(p - view.data()));
+            if (err != BurstError::NONE || part.size() == 0) continue;
+            std::unique_lock<std::mutex> lock(mu);
+            space_cv.wait(lock, [this] { return queue.size() < kStreamMaxQueued || cancelled; });
+            if (cancelled) break;
+            queue.emplace_back(std::move(part), (size_t)(p - view.data()));
+            ready_cv.notify_one();
+        }
+        std::lock_guard<std::mutex> lock(mu);
+        finished = true;
+        status = err;
+        ready_cv.notify_one();
+    }
+};
+
+BurstStream::BurstStream(const std::string& path) : state(new State) {
+    if (!state -> view.open(path)) {
+        state -> finished = true;
+        state -> status = BurstError::OPEN_FAILED;
+        return;
+    }
+    State* st = state.get();
+    state -> parser = std::thread([st] { st -> produce(); });
+}
+
+BurstStream::~BurstStream() {
+    if (state -> parser.joinable()) {
+        {
+            // Unblock a parser waiting for room; it stops instead of queueing more
+            std::lock_guard<std::mutex> lock(state -> mu);
+            state -> cancelled = true;
+        }
+        state -> space_cv.notify_one();
+        state -> parser.join();
+    }
+}
+
+bool BurstStream::next(BurstArena& chunk) {
+    std::unique_lock<std::mutex> lock(state -> mu);
+    state -> ready_cv.wait(lock, [this] { return !state -> queue.empty() || state -> finished; });
+    if (state -> queue.empty()) return false;
+    chunk = std::move(state -> queue.front().first);
+    state -> delivered = state -> queue.front().second;
+    state -> queue.pop_front();
+    state -> space_cv.notify_one();
+    return true;
+}
+
+size_t BurstStream::delivered() const { return state -> delivered; }
+
+size_t BurstStream::size() const { return state -> view.size(); }
+
+BurstError BurstStream::error() const {
+    std::lock_guard<std::mutex> lock(state -> mu);
+    return state -> finished && state -> queue.empty() ? state -> status : BurstError::NONE;
+}
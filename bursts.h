@@ -0,0 +1,158 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Burst file input. A burst file has one process per line, CPU/IO/CPU/... burst
+// lengths separated by whitespace; empty lines are skipped.
+//
+// A burst file can also be a binary trace written by `schedule --convert`, which
+// is mapped and used in place. All integers are native (little) endian:
+//   char     magic[8]            "SCHBRST1"
+//   uint64_t process_count
+//   uint64_t burst_count
+//   uint64_t reserved            0
+//   uint64_t offsets[process_count + 1]   process i owns bursts[offsets[i], offsets[i + 1])
+//   int32_t  bursts[burst_count]
+
+#ifndef BURSTS_H
+#define BURSTS_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Read-only view of the bursts of every process, CPU/IO/CPU/... per process.
+// Process i owns bursts[offsets[i], offsets[i + 1]) and always has an odd count.
+struct BurstSpan {
+    const int* bursts{nullptr};
+    const size_t* offsets{nullptr};
+    size_t count{0};
+
+    size_t size() const { return count; }
+    const int* line(size_t i) const { return bursts + offsets[i]; }
+    size_t line_size(size_t i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+// Owned bursts of every process in one contiguous array, laid out like BurstSpan
+struct BurstArena {
+    std::vector<int> bursts;
+    std::vector<size_t> offsets{0};
+
+    size_t size() const { return offsets.size() - 1; }
+    const int* line(size_t i) const { return bursts.data() + offsets[i]; }
+    size_t line_size(size_t i) const { return offsets[i + 1] - offsets[i]; }
+    void end_line() { offsets.push_back(bursts.size()); }
+    BurstSpan span() const { return BurstSpan{bursts.data(), offsets.data(), size()}; }
+};
+
+// Why a burst file was rejected
+enum class BurstError {
+    NONE,
+    OPEN_FAILED,  // the file could not be opened
+    NON_POSITIVE, // a burst number was 0 or negative
+    EVEN_COUNT,   // a line had an even number of bursts
+    BAD_BINARY,   // a binary trace whose header does not match its size
+};
+
+// Text scanner implementations. The vector ones classify a block of bytes at a
+// time and hand any line containing something other than digits and whitespace
+// to the scalar scanner, so all of them accept exactly the same input.
+enum class ScanIsa { SCALAR, SSE42, AVX2 };
+
+// Best scanner the running CPU supports, detected once
+ScanIsa best_scan_isa();
+
+// Parse the text in [begin, end) and append its processes to arena. Numbers are
+// read like `std::istream >> int` would read them line by line: a token that is not
+// a number (or overflows) ends its line silently. Stops at the first error.
+BurstError parse_bursts(const char* begin, const char* end, BurstArena& arena);
+BurstError parse_bursts(const char* begin, const char* end, BurstArena& arena, ScanIsa isa);
+
+// Same result as parse_bursts, using `threads` threads: the text is split into that
+// many chunks at line boundaries, each chunk is parsed on its own thread and the
+// results are stitched back in file order. On invalid input the error reported is
+// the one for the first invalid line in the file.
+BurstError parse_bursts_parallel(const char* begin, const char* end, BurstArena& arena, unsigned threads);
+
+// Parses a burst file on a background thread and hands it over in chunks of whole
+// lines through a bounded queue, so the consumer can start on the first processes
+// while the rest of the file is still being parsed. The parser never runs more
+// than a few chunks ahead of the consumer.
+class BurstStream {
+public:
+    // Opens path and starts parsing; error() is OPEN_FAILED if it could not be opened
+    explicit BurstStream(const std::string& path);
+    ~BurstStream();
+    BurstStream(const BurstStream&) = delete;
+    BurstStream& operator=(const BurstStream&) = delete;
+
+    // Blocks until the next chunk is parsed and moves it into chunk (offsets start at
+    // 0). Returns false once the input is exhausted or invalid; error() then says which.
+    bool next(BurstArena& chunk);
+    BurstError error() const;
+
+    // Bytes of the file the chunks taken so far cover, and the whole file's size,
+    // for the consumer to size its storage by
+    size_t delivered() const;
+    size_t size() const;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+
+// Map the file at path into memory and parse it in place into arena, with one
+// thread per core for files large enough to be worth splitting
+BurstError load_bursts(const std::string& path, BurstArena& arena);
+
+// Read-only view of a whole file: mmap for regular files, a read() loop for
+// anything that cannot be mapped (pipes, /dev/stdin). A read error ends the view
+// early, the same way a failing std::getline would end the input.
+struct FileView {
+    int fd{-1};
+    void* map{reinterpret_cast<void*>(-1)}; // MAP_FAILED
+    size_t len{0};
+    std::vector<char> copy;
+
+    FileView() = default;
+    ~FileView();
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+
+    bool open(const std::string& path);
+    const char* data() const;
+    size_t size() const { return len; }
+    // Done with the bytes before upto: drop whole pages of them from memory (mapped
+    // files only; they stay readable)
+    void release(size_t upto);
+};
+
+// A burst file in either format: text is parsed into an arena, a binary trace is
+// mapped and its offsets and bursts are used in place with no parse step, after one
+// pass that checks them like the text parser would
+class BurstFile {
+public:
+    BurstFile();
+    ~BurstFile();
+    BurstFile(const BurstFile&) = delete;
+    BurstFile& operator=(const BurstFile&) = delete;
+
+    BurstError open(const std::string& path);
+    // Same, parsing a text file on `threads` threads (0 for the default of one per
+    // core once it is large enough)
+    BurstError open(const std::string& path, unsigned threads);
+    BurstSpan span() const { return lines; }
+
+private:
+    BurstArena arena;
+    std::unique_ptr<FileView> mapped;
+    BurstSpan lines;
+};
+
+// True if the file at path starts with the binary trace magic
+bool is_binary_burst_file(const std::string& path);
+
+// Write lines as a binary trace; false if path could not be written
+bool save_bursts_binary(const std::string& path, const BurstSpan& lines);
+
+#endif
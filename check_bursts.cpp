@@ -0,0 +1,138 @@
+// File: check_bursts.cpp
+// Build: make check (builds ./check_bursts and runs it)
+// Run examples:
+// ./check_bursts                       # 1000 random inputs, seed 1
+// ./check_bursts 20000 7               # inputs, seed
+// ./check_bursts gen 2000 5 > in.txt   # write a valid input of 2000 processes
+//
+// Differential test of the burst parsers in bursts.h: every input is parsed by the
+// scalar scanner, and each vector scanner the CPU supports must return the same
+// error and the same processes. So must the parallel parser split over a few
+// thread counts, except that it leaves nothing in the arena on an error. The
+// inputs mix valid lines with the cases the vector scanners hand back to the
+// scalar one (signs, junk, overflow, CRLF, long lines), and a third of them
+// carry one invalid line somewhere.
+//
+// `gen` writes a plain valid input with short bursts instead, for make check to
+// run the scheduler on (a multi-core run must print the same with any -T).
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "bursts.h"
+
+// One line of the text format; bad picks the kind of invalid line, 0 for a valid one
+static void put_line(std::string& out, std::mt19937& rng, int bad) {
+    std::uniform_int_distribution<int> pick(0, 99);
+    auto space = [&] {
+        int n = pick(rng) < 80 ? 1 : 1 + pick(rng) % 40;
+        for (int i = 0; i < n; ++i) out += (pick(rng) < 85) ? ' ' : '\t';
+    };
+    if (pick(rng) < 10) space();
+    // Mostly short lines, some long enough to span several vector blocks
+    int count = 2 * (pick(rng) < 90 ? pick(rng) % 8 : pick(rng) * 4) + 1;
+    if (bad == 1) ++count;
+    int bad_at = bad > 1 ? (int)(rng() % (unsigned)count) : -1;
+    for (int i = 0; i < count; ++i) {
+        if (i) space();
+        if (i == bad_at) {
+            static const char* invalid[] = {"0", "-3", "00"};
+            out += invalid[rng() % 3];
+            continue;
+        }
+        int kind = pick(rng);
+        if (kind < 2) out += "+";
+        if (kind == 2) out += "0";
+        out += std::to_string(1 + (pick(rng) < 70 ? pick(rng) : (int)(rng() % 2000000000u)));
+        // A token that ends the line silently, like `>> int` would stop there
+        if (kind == 3 && bad == 0) {
+            static const char* junk[] = {"x", "ms", "99999999999", "2147483648", ".5"};
+            out += junk[rng() % 5];
+        }
+    }
+    if (pick(rng) < 10) space();
+    out += (pick(rng) < 20) ? "\r\n" : "\n";
+    if (pick(rng) < 5) out += (pick(rng) < 50) ? "\n" : " \t\n";
+}
+
+static std::string random_input(std::mt19937& rng) {
+    std::uniform_int_distribution<int> pick(0, 99);
+    int lines = pick(rng) < 50 ? pick(rng) % 20 : 20 + (int)(rng() % 2000);
+    int bad_line = pick(rng) < 33 ? (int)(rng() % (unsigned)(lines + 1)) : -1;
+    std::string out;
+    for (int i = 0; i < lines; ++i) put_line(out, rng, i == bad_line ? 1 + (int)(rng() % 2) : 0);
+    // Sometimes no newline at the very end
+    if (!out.empty() && pick(rng) < 20) out.pop_back();
+    return out;
+}
+
+static bool same(BurstError ea, const BurstArena& a, BurstError eb, const BurstArena& b) {
+    return ea == eb && a.bursts == b.bursts && a.offsets == b.offsets;
+}
+
+static const char* isa_name(ScanIsa isa) {
+    switch (isa) {
+        case ScanIsa::SCALAR: return "scalar";
+        case ScanIsa::SSE42: return "sse4.2";
+        case ScanIsa::AVX2: return "avx2";
+    }
+    return "";
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "gen") {
+        int processes = argc > 2 ? std::atoi(argv[2]) : 1000;
+        std::mt19937 rng(argc > 3 ? (unsigned)std::strtoul(argv[3], nullptr, 10) : 1);
+        std::uniform_int_distribution<int> count(0, 7), burst(1, 100);
+        for (int i = 0; i < processes; ++i) {
+            int n = 2 * count(rng) + 1;
+            for (int j = 0; j < n; ++j) std::printf(j ? " %d" : "%d", burst(rng));
+            std::printf("\n");
+        }
+        return 0;
+    }
+    int inputs = argc > 1 ? std::atoi(argv[1]) : 1000;
+    unsigned seed = argc > 2 ? (unsigned)std::strtoul(argv[2], nullptr, 10) : 1;
+    if (inputs <= 0) {
+        std::printf("Usage: %s [inputs] [seed]\n", argv[0]);
+        return 0;
+    }
+    std::vector<ScanIsa> isas;
+    if (best_scan_isa() >= ScanIsa::SSE42) isas.push_back(ScanIsa::SSE42);
+    if (best_scan_isa() >= ScanIsa::AVX2) isas.push_back(ScanIsa::AVX2);
+
+    std::mt19937 rng(seed);
+    int failures = 0;
+    for (int n = 0; n < inputs; ++n) {
+        std::string text = random_input(rng);
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        BurstArena expected;
+        BurstError expected_err = parse_bursts(begin, end, expected, ScanIsa::SCALAR);
+        for (ScanIsa isa : isas) {
+            BurstArena got;
+            BurstError err = parse_bursts(begin, end, got, isa);
+            if (!same(expected_err, expected, err, got)) {
+                std::printf("input %d (seed %u): %s differs from scalar\n", n, seed, isa_name(isa));
+                ++failures;
+            }
+        }
+        // More chunks than lines too, so some chunks are empty
+        for (unsigned threads : {2u, 3u, 8u, 64u}) {
+            BurstArena got;
+            BurstError err = parse_bursts_parallel(begin, end, got, threads);
+            bool ok = (err == BurstError::NONE) ? same(expected_err, expected, err, got) : err == expected_err;
+            if (!ok) {
+                std::printf("input %d (seed %u): %u threads differ from scalar\n", n, seed, threads);
+                ++failures;
+            }
+        }
+    }
+    std::printf("%d inputs, scanners:", inputs);
+    for (ScanIsa isa : isas) std::printf(" %s", isa_name(isa));
+    std::printf(" and 2-64 parse threads against scalar: %s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
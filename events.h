@@ -0,0 +1,131 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Log events as fixed-size binary records, and the lock-free queue that carries
+// them from the scheduler thread to the thread that formats and writes them.
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "log.h"
+
+// Core field of the events of a single-CPU run, which name no core
+static const int NO_CORE = -1;
+
+// One log call. The meaning of the value fields depends on the kind:
+//   EXECUTION   log_cpuburst_execution(pid, cpu, io, elapsed, reason), or
+//               log_cpuburst_execution_core(core, ...) unless core is NO_CORE
+//   COMPLETION  log_process_completion(pid, elapsed = turnaround, cpu = wait)
+//   ECHO        log_process_bursts for every input line (written by the consumer
+//               because the input is only known to be valid at the end of a stream)
+//   END         no more records; the consumer flushes and stops
+struct LogRecord {
+    enum Kind : uint8_t { EXECUTION, COMPLETION, ECHO, END };
+
+    uint8_t kind;
+    uint8_t reason; // ExecutionStopReasonType
+    int16_t core;   // EXECUTION: NO_CORE, or the core of a multi-core run
+    uint32_t pid;
+    int cpu;
+    int io;
+    int elapsed;
+
+    static LogRecord execution(uint32_t pid, int cpu, int io, int elapsed, ExecutionStopReasonType reason, int core) {
+        return LogRecord{EXECUTION, (uint8_t)reason, (int16_t)core, pid, cpu, io, elapsed};
+    }
+    static LogRecord completion(uint32_t pid, int turnaround, int wait) {
+        return LogRecord{COMPLETION, 0, NO_CORE, pid, wait, 0, turnaround};
+    }
+    static LogRecord marker(Kind kind) { return LogRecord{kind, 0, NO_CORE, 0, 0, 0, 0}; }
+};
+
+// Bounded single-producer/single-consumer ring. Head and tail live on their own
+// cache lines and each side keeps a cached copy of the other's index, so in the
+// steady state a push or pop touches no shared cache line besides the slot.
+// A full ring pushes back on the producer, which yields until there is room. An
+// empty one can put the consumer to sleep. The producer wakes it once a batch of
+// records has built up (or on flush()), so a sleeping consumer costs one lock and
+// one wake-up per batch rather than per record; a wake-up that is not sent (a
+// batch still building up) costs at most the wait's timeout. Whether one is sent
+// is a Dekker-style handshake: each side stores its flag (tail, sleeping), then a
+// seq_cst fence, then reads the other's, so at least one of them sees the other.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        slots.resize(cap);
+        mask = cap - 1;
+    }
+
+    // Producer side
+    void push(const T& v) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        while (t - head_cache > mask) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache > mask) std::this_thread::yield();
+        }
+        slots[t & mask] = v;
+        tail.store(t + 1, std::memory_order_release);
+        // head_cache may be behind, which only makes the batch look bigger
+        if (t + 1 - head_cache > (mask >> 3)) flush();
+    }
+
+    // Producer side: wake the consumer if it is asleep
+    void flush() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!sleeping.load(std::memory_order_relaxed) || !sleeping.exchange(false, std::memory_order_relaxed)) return;
+        std::lock_guard<std::mutex> lock(mu);
+        wake.notify_one();
+    }
+
+    // Consumer side: copy up to max records into out, returns how many
+    size_t pop(T* out, size_t max) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (tail_cache == h) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (tail_cache == h) return 0;
+        }
+        size_t n = (size_t)(tail_cache - h);
+        if (n > max) n = max;
+        for (size_t i = 0; i < n; ++i) out[i] = slots[(h + i) & mask];
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side: sleep until something is pushed, or for timeout at most. It
+    // yields once first, which on a busy machine is usually enough for the
+    // producer to fill the ring again without either side going to sleep
+    void wait(std::chrono::microseconds timeout) {
+        std::this_thread::yield();
+        if (tail.load(std::memory_order_acquire) != head.load(std::memory_order_relaxed)) return;
+        std::unique_lock<std::mutex> lock(mu);
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h) wake.wait_for(lock, timeout);
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> slots;
+    uint64_t mask{0};
+    alignas(64) std::atomic<uint64_t> head{0}; // next slot to pop, written by the consumer
+    uint64_t tail_cache{0};                    // consumer's view of tail
+    alignas(64) std::atomic<uint64_t> tail{0}; // next slot to push, written by the producer
+    uint64_t head_cache{0};                    // producer's view of head
+    alignas(64) std::atomic<bool> sleeping{false}; // the consumer is in wait()
+    std::mutex mu;
+    std::condition_variable wake;
+};
+
+#endif
@@ -0,0 +1,108 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+
+#include "format_pool.h"
+
+#include "log.h"
+
+FormatPool::FormatPool(unsigned threads, size_t size): block_size(size) {
+    if (threads == 0) threads = 1;
+    // Enough to keep every worker busy while main writes the oldest block
+    max_in_flight = 2 * (size_t)threads;
+    for (unsigned i = 0; i < threads; ++i) workers.emplace_back([this] { work(); });
+}
+
+FormatPool::~FormatPool() {
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void FormatPool::add(const LogRecord& r) {
+    if (!current) {
+        if (spare.empty()) {
+            blocks.emplace_back(new Block);
+            blocks.back() -> records.reserve(block_size);
+            blocks.back() -> text.resize(block_size * LOG_MAX_EVENT_TEXT);
+            spare.push_back(blocks.back().get());
+        }
+        current = spare.back();
+        spare.pop_back();
+        current -> records.clear();
+    }
+    current -> records.push_back(r);
+    if (current -> records.size() == block_size) submit();
+}
+
+void FormatPool::submit() {
+    if (!current) return;
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        current -> done = false;
+        queue.push_back(current);
+        in_flight.push_back(current);
+    }
+    current = nullptr;
+    work_cv.notify_one();
+    write_finished(false);
+}
+
+void FormatPool::sync() {
+    submit();
+    write_finished(true);
+}
+
+void FormatPool::write_finished(bool wait) {
+    std::unique_lock<std::mutex> lock(mu);
+    while (!in_flight.empty()) {
+        Block* b = in_flight.front();
+        if (!b -> done) {
+            // Only wait when asked to, or when there are too many blocks out
+            if (!wait && in_flight.size() < max_in_flight) break;
+            done_cv.wait(lock, [b] { return b -> done; });
+        }
+        in_flight.pop_front();
+        lock.unlock();
+        log_write_text(b -> text.data(), b -> length);
+        lock.lock();
+        spare.push_back(b);
+    }
+}
+
+void FormatPool::work() {
+    while (true) {
+        Block* b;
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            work_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            b = queue.front();
+            queue.pop_front();
+        }
+        char* out = b -> text.data();
+        for (const LogRecord& r : b -> records) {
+            if (r.kind == LogRecord::EXECUTION) {
+                log_execution_event e = {r.pid, (unsigned)r.cpu, (unsigned)r.io, (unsigned)r.elapsed,
+                                         (ExecutionStopReasonType)r.reason};
+                if (r.core == NO_CORE) {
+                    out += log_format_cpuburst_execution(out, &e);
+                } else {
+                    log_core_execution_event c = {(unsigned)r.core, e};
+                    out += log_format_cpuburst_execution_core(out, &c);
+                }
+            } else {
+                log_completion_event e = {r.pid, (unsigned)r.elapsed, (unsigned)r.cpu};
+                out += log_format_process_completion(out, &e);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            b -> length = (size_t)(out - b -> text.data());
+            b -> done = true;
+        }
+        done_cv.notify_all();
+    }
+}
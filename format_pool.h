@@ -0,0 +1,65 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Text formatting spread over worker threads. Log records are collected into
+// numbered blocks, each block is formatted to text by whichever worker is free,
+// and the finished blocks are written in block order, so the output is exactly
+// what formatting the records one by one would give.
+
+#ifndef FORMAT_POOL_H
+#define FORMAT_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "events.h"
+
+class FormatPool {
+public:
+    // threads workers; blocks of block_size records
+    FormatPool(unsigned threads, size_t block_size);
+    ~FormatPool();
+    FormatPool(const FormatPool&) = delete;
+    FormatPool& operator=(const FormatPool&) = delete;
+
+    // Queue an EXECUTION or COMPLETION record. Hands the block to the workers when
+    // it is full and writes out any blocks that are finished, in order. Blocks if
+    // too many are still being formatted.
+    void add(const LogRecord& r);
+
+    // Format and write everything added so far, waiting for the workers
+    void sync();
+
+private:
+    struct Block {
+        std::vector<LogRecord> records;
+        std::vector<char> text;
+        size_t length{0};
+        bool done{false};
+    };
+
+    void submit();
+    // Write the finished blocks at the front; with wait, every submitted block
+    void write_finished(bool wait);
+    void work();
+
+    size_t block_size;
+    size_t max_in_flight;
+    Block* current{nullptr};             // being filled by add()
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::vector<Block*> spare;
+
+    std::mutex mu;
+    std::condition_variable work_cv;     // a block was queued, or stopping
+    std::condition_variable done_cv;     // a block was formatted
+    std::deque<Block*> queue;            // waiting for a worker
+    std::deque<Block*> in_flight;        // submitted, in output order
+    bool stopping{false};
+    std::vector<std::thread> workers;
+};
+
+#endif
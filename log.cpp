@@ -1,7 +1,11 @@
 // Author: Jimmy Ly
 // Date: October 6 2025
 
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "log.h"
 /* Handle C++ namespaces, ignore if compiled in C
 * C++ usually uses this #define to declare the C++ standard.
@@ -16,6 +20,168 @@ using namespace std;
 */
 /* Names of producer threads and request types */
 const char *executionStopReason[] = {"enter io", "quantum expired", "completed"};
+/*
+* Output sink. Lines are formatted straight into one large buffer with a
+* hand-rolled integer formatter and written out with write(2) when it fills up,
+* instead of having printf parse its format string and lock stdout per event.
+* The bytes produced are exactly what the printf formats would produce.
+*/
+#define LOG_BUFFER_SIZE (1 << 18)
+/* Longest line a single log call appends before checking for room again */
+#define LOG_MAX_LINE LOG_MAX_EVENT_TEXT
+static char log_buffer[LOG_BUFFER_SIZE];
+static size_t log_used = 0;
+static int log_fd = 1;
+static bool log_exit_hook = false;
+/* Registered sink, NULL for the text output above */
+static const log_sink_vtable *log_sink = NULL;
+/* Two digit lookup table, "00" "01" ... "99" */
+static const char log_digits[] =
+"0001020304050607080910111213141516171819"
+"2021222324252627282930313233343536373839"
+"4041424344454647484950515253545556575859"
+"6061626364656667686970717273747576777879"
+"8081828384858687888990919293949596979899";
+/**
+* @brief write value at out like printf("%d") does (the log functions take
+* unsigned ints but have always printed them as int), returns the end
+*
+* @param out
+* @param value
+*/
+static char *log_put_int (char *out, unsigned int value) {
+char tmp[12];
+char *end = tmp + sizeof(tmp);
+char *p = end;
+int v = (int)value;
+unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+while (u >= 100) {
+unsigned int r = (u % 100) * 2;
+u /= 100;
+*--p = log_digits[r + 1];
+*--p = log_digits[r];
+}
+if (u >= 10) {
+*--p = log_digits[u * 2 + 1];
+*--p = log_digits[u * 2];
+} else {
+*--p = (char)('0' + u);
+}
+if (v < 0) *--p = '-';
+memcpy(out, p, (size_t)(end - p));
+return out + (end - p);
+}
+static char *log_put_str (char *out, const char *s, size_t len) {
+memcpy(out, s, len);
+return out + len;
+}
+#define LOG_PUT_LITERAL(out, s) out = log_put_str(out, s, sizeof(s) - 1)
+static void log_flush_text (void);
+/* Make room for one more line, and make sure the buffer is flushed at exit */
+static void log_reserve (void) {
+if (!log_exit_hook) {
+log_exit_hook = true;
+atexit(log_flush_text);
+}
+if (log_used + LOG_MAX_LINE > LOG_BUFFER_SIZE) log_flush_text();
+}
+static void log_write_all (const char *text, size_t len) {
+size_t done = 0;
+while (done < len) {
+ssize_t n = write(log_fd, text + done, len - done);
+if (n < 0) {
+if (errno == EINTR) continue;
+break;
+}
+done += (size_t)n;
+}
+}
+/* Write out the text buffer */
+static void log_flush_text (void) {
+log_write_all(log_buffer, log_used);
+log_used = 0;
+}
+void log_write_text (const char *text, size_t len) {
+if (!log_exit_hook) {
+log_exit_hook = true;
+atexit(log_flush_text);
+}
+if (log_used + len > LOG_BUFFER_SIZE) log_flush_text();
+if (len >= LOG_BUFFER_SIZE) {
+log_write_all(text, len);
+return;
+}
+memcpy(log_buffer + log_used, text, len);
+log_used += len;
+}
+void log_flush (void) {
+if (log_sink && log_sink->flush) log_sink->flush(log_sink->context);
+log_flush_text();
+}
+void log_set_output_fd (int fd) {
+log_flush();
+log_fd = fd;
+}
+void log_set_sink (const log_sink_vtable *sink) {
+log_flush();
+log_sink = sink;
+}
+const log_sink_vtable *log_get_sink (void) {
+return log_sink;
+}
+size_t log_format_cpuburst_execution (char *out, const log_execution_event *event) {
+// print according to this format
+// P0: cpu executed = 3, io executed = 0, time elapsed = 3, enter io
+// "P%d: executed cpu bursts = %d, executed io bursts = %d, time elapsed = %d, %s\n"
+const char *reason = executionStopReason[event->stopReason];
+char *p = out;
+LOG_PUT_LITERAL(p, "P");
+p = log_put_int(p, event->procID);
+LOG_PUT_LITERAL(p, ": executed cpu bursts = ");
+p = log_put_int(p, event->cpuExecutedTime);
+LOG_PUT_LITERAL(p, ", executed io bursts = ");
+p = log_put_int(p, event->ioExecutedTime);
+LOG_PUT_LITERAL(p, ", time elapsed = ");
+p = log_put_int(p, event->totalElapsedTime);
+LOG_PUT_LITERAL(p, ", ");
+p = log_put_str(p, reason, strlen(reason));
+LOG_PUT_LITERAL(p, "\n");
+return (size_t)(p - out);
+}
+size_t log_format_cpuburst_execution_core (char *out, const log_core_execution_event *event) {
+// The execution line with the core after the process
+// "P%d on core %d: executed cpu bursts = %d, executed io bursts = %d, time elapsed = %d, %s\n"
+const log_execution_event *e = &event->execution;
+const char *reason = executionStopReason[e->stopReason];
+char *p = out;
+LOG_PUT_LITERAL(p, "P");
+p = log_put_int(p, e->procID);
+LOG_PUT_LITERAL(p, " on core ");
+p = log_put_int(p, event->coreID);
+LOG_PUT_LITERAL(p, ": executed cpu bursts = ");
+p = log_put_int(p, e->cpuExecutedTime);
+LOG_PUT_LITERAL(p, ", executed io bursts = ");
+p = log_put_int(p, e->ioExecutedTime);
+LOG_PUT_LITERAL(p, ", time elapsed = ");
+p = log_put_int(p, e->totalElapsedTime);
+LOG_PUT_LITERAL(p, ", ");
+p = log_put_str(p, reason, strlen(reason));
+LOG_PUT_LITERAL(p, "\n");
+return (size_t)(p - out);
+}
+size_t log_format_process_completion (char *out, const log_completion_event *event) {
+// print according to this format
+// "P%d: turnaround time = %d, wait time = %d\n"
+char *p = out;
+LOG_PUT_LITERAL(p, "P");
+p = log_put_int(p, event->procID);
+LOG_PUT_LITERAL(p, ": turnaround time = ");
+p = log_put_int(p, event->completionTime);
+LOG_PUT_LITERAL(p, ", wait time = ");
+p = log_put_int(p, event->totalWaitTime);
+LOG_PUT_LITERAL(p, "\n");
+return (size_t)(p - out);
+}
 /**
 * @brief
 *
@@ -30,11 +196,48 @@ unsigned int cpuExecutedTime,
 unsigned int ioExecutedTime,
 unsigned int totalElapsedTime,
 ExecutionStopReasonType stopReason) {
-// print according to this format
-// P0: cpu executed = 3, io executed = 0, time elapsed = 3, enter io
-printf("P%d: executed cpu bursts = %d, executed io bursts = %d, time elapsed = %d, %s\n",
-procID, cpuExecutedTime, ioExecutedTime, totalElapsedTime,
-executionStopReason[stopReason]);
+log_execution_event event = {procID, cpuExecutedTime, ioExecutedTime, totalElapsedTime, stopReason};
+if (log_sink) {
+if (log_sink->cpuburst_execution) log_sink->cpuburst_execution(log_sink->context, &event);
+return;
+}
+log_reserve();
+log_used += log_format_cpuburst_execution(log_buffer + log_used, &event);
+}
+void log_cpuburst_execution_batch (const log_execution_event events[], size_t count) {
+if (log_sink && log_sink->cpuburst_execution_batch) {
+log_sink->cpuburst_execution_batch(log_sink->context, events, count);
+return;
+}
+for (size_t i = 0; i < count; i++) {
+log_cpuburst_execution(events[i].procID, events[i].cpuExecutedTime, events[i].ioExecutedTime,
+events[i].totalElapsedTime, events[i].stopReason);
+}
+}
+/**
+* @brief
+*
+* @param coreID
+* @param procID
+* @param cpuExecutedTime
+* @param ioExecutedTime
+* @param totalElapsedTime
+* @param stopReason
+*/
+void log_cpuburst_execution_core (unsigned int coreID,
+unsigned int procID,
+unsigned int cpuExecutedTime,
+unsigned int ioExecutedTime,
+unsigned int totalElapsedTime,
+ExecutionStopReasonType stopReason) {
+log_core_execution_event event = {coreID, {procID, cpuExecutedTime, ioExecutedTime, totalElapsedTime, stopReason}};
+if (log_sink) {
+if (log_sink->cpuburst_execution_core) log_sink->cpuburst_execution_core(log_sink->context, &event);
+else if (log_sink->cpuburst_execution) log_sink->cpuburst_execution(log_sink->context, &event.execution);
+return;
+}
+log_reserve();
+log_used += log_format_cpuburst_execution_core(log_buffer + log_used, &event);
 }
 /**
 * @brief
@@ -42,17 +245,26 @@ executionStopReason[stopReason]);
 * @param bursts - 1D array
 */
 void log_process_bursts (unsigned int bursts[], size_t numOfBursts) {
+if (log_sink) {
+if (log_sink->process_bursts) log_sink->process_bursts(log_sink->context, bursts, numOfBursts);
+return;
+}
 for (size_t i = 0; i < numOfBursts; i++) {
 // Print integers on one line.
-printf("%d ", bursts[i]);
+// "%d "
+log_reserve();
+char *p = log_put_int(log_buffer + log_used, bursts[i]);
+LOG_PUT_LITERAL(p, " ");
+log_used = (size_t)(p - log_buffer);
 }
-printf("\n");
+log_reserve();
+log_buffer[log_used++] = '\n';
 /* This is not really needed, but will be helpful for making sure that you
 * see output prior to a segmentation violation. This is not usually a
 * good practice as we want to avoid ending the CPU burst premaurely which
 * this will do, but it is a helpful technique.
 */
-// fflush(stdout);
+// log_flush();
 }
 /**
 * @brief
@@ -66,7 +278,20 @@ unsigned int completionTime,
 // wait time is the time spent in the ready queue
 // wait time = completionTime - total cpu bursts - total io bursts
 unsigned int totalWaitTime) {
-// print according to this format
-printf("P%d: turnaround time = %d, wait time = %d\n",
-procID, completionTime, totalWaitTime);
+log_completion_event event = {procID, completionTime, totalWaitTime};
+if (log_sink) {
+if (log_sink->process_completion) log_sink->process_completion(log_sink->context, &event);
+return;
+}
+log_reserve();
+log_used += log_format_process_completion(log_buffer + log_used, &event);
+}
+void log_process_completion_batch (const log_completion_event events[], size_t count) {
+if (log_sink && log_sink->process_completion_batch) {
+log_sink->process_completion_batch(log_sink->context, events, count);
+return;
+}
+for (size_t i = 0; i < count; i++) {
+log_process_completion(events[i].procID, events[i].completionTime, events[i].totalWaitTime);
+}
 }
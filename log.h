@@ -19,11 +19,16 @@
 */
 #ifdef __cplusplus
 /* C++ includes */
+#include <stddef.h>
 #include <stdint.h>
 #else
 /* C includes */
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
+#endif
+#ifdef __cplusplus
+extern "C" {
 #endif
 /*
 * structure used for tracking execution stop reasons
@@ -51,6 +56,23 @@ unsigned int ioExecutedTime,
 unsigned int totalElapsedTime,
 ExecutionStopReasonType stopReason);
 /**
+* @brief log_cpuburst_execution for a multi-core run, naming the core the
+* process ran on
+*
+* @param coreID
+* @param procID
+* @param cpuExecutedTime
+* @param ioExecutedTime
+* @param totalElapsedTime
+* @param stopReason
+*/
+void log_cpuburst_execution_core (unsigned int coreID,
+unsigned int procID,
+unsigned int cpuExecutedTime,
+unsigned int ioExecutedTime,
+unsigned int totalElapsedTime,
+ExecutionStopReasonType stopReason);
+/**
 * @brief
 *
 * @param bursts - 1D array
@@ -68,4 +90,131 @@ unsigned int completionTime,
 // wait time is the time spent in the ready queue
 // wait time = completionTime - total cpu bursts - total io bursts
 unsigned int totalWaitTime);
+/**
+* @brief Write out everything the log functions have buffered.
+* Output is collected in a large buffer and written with write(2) when the
+* buffer fills up; it is also flushed automatically when the program exits.
+*/
+void log_flush (void);
+/**
+* @brief Flush, then send all further log output to fd (stdout by default)
+*
+* @param fd
+*/
+void log_set_output_fd (int fd);
+/*
+* Pluggable sinks
+*
+* By default the log functions above format text to stdout. An embedder can
+* register a sink instead and receive the events in-process, with no text round
+* trip. The batch functions deliver arrays of events in one call; they are what
+* the scheduler uses for runs of consecutive events.
+*/
+/* One log_cpuburst_execution call */
+typedef struct {
+unsigned int procID;
+unsigned int cpuExecutedTime;
+unsigned int ioExecutedTime;
+unsigned int totalElapsedTime;
+ExecutionStopReasonType stopReason;
+} log_execution_event;
+/* One log_process_completion call */
+typedef struct {
+unsigned int procID;
+unsigned int completionTime;
+unsigned int totalWaitTime;
+} log_completion_event;
+/* One log_cpuburst_execution_core call */
+typedef struct {
+unsigned int coreID;
+log_execution_event execution;
+} log_core_execution_event;
+/*
+* Callbacks of a sink, each passed the context pointer first.
+* A NULL batch callback makes the batch functions call the single event callback
+* once per event; a NULL single event callback drops those events. flush is
+* called by log_flush and may be NULL. A NULL cpuburst_execution_core passes
+* those events to cpuburst_execution, without the core.
+*/
+typedef struct {
+void *context;
+void (*cpuburst_execution) (void *context, const log_execution_event *event);
+void (*process_bursts) (void *context, const unsigned int bursts[], size_t numOfBursts);
+void (*process_completion) (void *context, const log_completion_event *event);
+void (*cpuburst_execution_batch) (void *context, const log_execution_event *events, size_t count);
+void (*process_completion_batch) (void *context, const log_completion_event *events, size_t count);
+void (*flush) (void *context);
+void (*cpuburst_execution_core) (void *context, const log_core_execution_event *event);
+} log_sink_vtable;
+/**
+* @brief Flush, then send all further log calls to sink. The vtable is used
+* in place and must stay valid until it is replaced. NULL restores the default
+* text output.
+*
+* @param sink
+*/
+void log_set_sink (const log_sink_vtable *sink);
+/**
+* @brief The registered sink, NULL for the default text output
+*/
+const log_sink_vtable *log_get_sink (void);
+/**
+* @brief log_cpuburst_execution for each of events, in order
+*
+* @param events - 1D array
+* @param count
+*/
+void log_cpuburst_execution_batch (const log_execution_event events[], size_t count);
+/**
+* @brief log_process_completion for each of events, in order
+*
+* @param events - 1D array
+* @param count
+*/
+void log_process_completion_batch (const log_completion_event events[], size_t count);
+/*
+* Formatting without output
+*
+* The text of one event, formatted into a caller's buffer instead of the log
+* output. These use no shared state and may be called from any thread, so
+* blocks of events can be formatted in parallel and written in order with
+* log_write_text. They produce exactly the bytes the log functions would write.
+*/
+/* Most bytes the text of one execution or completion event takes */
+#define LOG_MAX_EVENT_TEXT 160
+/**
+* @brief Format event at out, returns the number of bytes written
+* (at most LOG_MAX_EVENT_TEXT, no terminating zero)
+*
+* @param out
+* @param event
+*/
+size_t log_format_cpuburst_execution (char *out, const log_execution_event *event);
+/**
+* @brief Format event at out, returns the number of bytes written
+* (at most LOG_MAX_EVENT_TEXT, no terminating zero)
+*
+* @param out
+* @param event
+*/
+size_t log_format_process_completion (char *out, const log_completion_event *event);
+/**
+* @brief Format event at out, returns the number of bytes written
+* (at most LOG_MAX_EVENT_TEXT, no terminating zero)
+*
+* @param out
+* @param event
+*/
+size_t log_format_cpuburst_execution_core (char *out, const log_core_execution_event *event);
+/**
+* @brief Append already formatted text to the text output, after everything
+* logged before it
+*
+* @param text
+* @param len
+*/
+void log_write_text (const char *text, size_t len);
+#ifdef __cplusplus
+}
+#endif
 #endif
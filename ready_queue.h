@@ -0,0 +1,165 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Ready queue of process indices (pids). Indices stay valid however the process
+// table is stored, and take half the space of pointers. IndexHeap is the ready
+// queue of the shortest-first strategies. CoreSet keeps track of which cores of a
+// multi-core run are idle, or have processes queued.
+
+#ifndef READY_QUEUE_H
+#define READY_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed-capacity FIFO ring buffer. A process is in the ready queue at most once,
+// so sizing it for every process up front means push never needs a fullness check
+// and the steady state never allocates. Capacity is rounded up to a power of two
+// so wrapping is a mask; head and tail only ever grow, so empty is head == tail.
+class IndexRing {
+public:
+    void reset(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        buf.assign(cap, 0);
+        mask = cap - 1;
+        head = tail = 0;
+    }
+
+    // Grow to hold at least capacity entries, keeping the queued ones in order.
+    // Only called when more processes are admitted, never from the dispatch loop.
+    void reserve(size_t capacity) {
+        if (capacity <= buf.size()) return;
+        size_t cap = buf.empty() ? 1 : buf.size();
+        while (cap < capacity) cap <<= 1;
+        std::vector<uint32_t> grown(cap, 0);
+        size_t n = size();
+        for (size_t i = 0; i < n; ++i) grown[i] = buf[(head + i) & mask];
+        buf.swap(grown);
+        mask = cap - 1;
+        head = 0;
+        tail = n;
+    }
+
+    bool empty() const { return head == tail; }
+    size_t size() const { return (size_t)(tail - head); }
+    size_t capacity() const { return buf.size(); }
+
+    void push(uint32_t p) { buf[tail++ & mask] = p; }
+    uint32_t front() const { return buf[head & mask]; }
+    uint32_t pop() { return buf[head++ & mask]; }
+
+private:
+    std::vector<uint32_t> buf;
+    uint64_t mask{0};
+    uint64_t head{0};
+    uint64_t tail{0};
+};
+
+// Binary min-heap of process indices by key (the CPU left in the current burst),
+// first come first served among equal keys. An entry carries its key and arrival
+// number, and a queued process never changes its key, so push and pop are
+// O(log n) sifts with no table of heap positions to keep up. Sized for every
+// process up front, like IndexRing, so the steady state never allocates.
+class IndexHeap {
+public:
+    void reset(size_t capacity) {
+        heap.clear();
+        heap.reserve(capacity);
+        arrivals = 0;
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    uint32_t top() const { return heap.front().proc; }
+    int top_key() const { return heap.front().key; }
+
+    void push(uint32_t p, int key) {
+        Entry e{key, p, arrivals++};
+        size_t i = heap.size();
+        heap.push_back(e);
+        // Sift up by moving parents into the hole, then drop the entry in once
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!before(e, heap[parent])) break;
+            heap[i] = heap[parent];
+            i = parent;
+        }
+        heap[i] = e;
+    }
+
+    uint32_t pop() {
+        uint32_t p = heap.front().proc;
+        Entry last = heap.back();
+        heap.pop_back();
+        size_t n = heap.size();
+        if (n == 0) return p;
+        size_t i = 0;
+        while (true) {
+            size_t child = 2 * i + 1;
+            if (child >= n) break;
+            if (child + 1 < n && before(heap[child + 1], heap[child])) ++child;
+            if (!before(heap[child], last)) break;
+            heap[i] = heap[child];
+            i = child;
+        }
+        heap[i] = last;
+        return p;
+    }
+
+private:
+    struct Entry {
+        int key;
+        uint32_t proc;
+        uint64_t arrival;
+    };
+
+    static bool before(const Entry& a, const Entry& b) {
+        return a.key < b.key || (a.key == b.key && a.arrival < b.arrival);
+    }
+
+    std::vector<Entry> heap;
+    uint64_t arrivals{0};
+};
+
+// Set of core indices as a bitmap, so the cores in it can be found in index order
+// a word at a time
+class CoreSet {
+public:
+    static const uint32_t NONE = UINT32_MAX;
+
+    void reset(size_t cores) { bits.assign((cores + 63) / 64, 0); }
+    void insert(uint32_t c) { bits[c >> 6] |= 1ULL << (c & 63); }
+    void erase(uint32_t c) { bits[c >> 6] &= ~(1ULL << (c & 63)); }
+
+    // Lowest member at or after c, NONE if there is none
+    uint32_t next(uint32_t c) const {
+        size_t w = c >> 6;
+        if (w >= bits.size()) return NONE;
+        uint64_t m = bits[w] & (~0ULL << (c & 63));
+        while (!m) {
+            if (++w == bits.size()) return NONE;
+            m = bits[w];
+        }
+        return (uint32_t)(w * 64 + __builtin_ctzll(m));
+    }
+
+    // Lowest member of both a and b at or after c, NONE if there is none
+    static uint32_t next_common(const CoreSet& a, const CoreSet& b, uint32_t c) {
+        size_t w = c >> 6;
+        if (w >= a.bits.size()) return NONE;
+        uint64_t m = a.bits[w] & b.bits[w] & (~0ULL << (c & 63));
+        while (!m) {
+            if (++w == a.bits.size()) return NONE;
+            m = a.bits[w] & b.bits[w];
+        }
+        return (uint32_t)(w * 64 + __builtin_ctzll(m));
+    }
+
+private:
+    std::vector<uint64_t> bits;
+};
+
+#endif
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <climits>
+#include <condition_variable>
 #include <csignal>
 #include <cstdarg>
 #include <cstddef>
@@ -14,52 +16,124 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
-#include <deque>
-#include <fstream>
+#include <dirent.h>
+#include <functional>
 #include <getopt.h>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <numeric>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <tuple>
 #include <thread>
 #include <utility>
 #include <vector>
+#include "blocked_queue.h"
+#include "bursts.h"
+#include "events.h"
+#include "format_pool.h"
 #include "log.h"
+#include "ready_queue.h"
+#include "sinks.h"
+#include "trace.h"
+#include "work_pool.h"
 
-struct BurstLine {
-    // Original bursts
-    std::vector<int> bursts; // odd count, CPU/IO/CPU/...
-};
+// Structure-of-arrays process table, index i is pid i. The bursts themselves stay in
+// the BurstArena; a process only keeps a cursor into it and the hot counters.
+struct ProcTable {
+    std::vector<size_t> cursor;        // arena index of the current burst
+    std::vector<int> remaining;        // what is left of the current burst
+    std::vector<int> executed_cpu;
+    std::vector<int> executed_io;
+    std::vector<int> completion_time;
+
+    size_t size() const { return cursor.size(); }
+
+    void assign(const BurstSpan& arena) {
+        cursor.clear(); remaining.clear(); executed_cpu.clear(); executed_io.clear(); completion_time.clear();
+        append(arena);
+    }
+
+    void reserve(size_t n) {
+        cursor.reserve(n); remaining.reserve(n); executed_cpu.reserve(n); executed_io.reserve(n); completion_time.reserve(n);
+    }
 
-struct Proc {
-    int pid;
-    std::deque<int> bursts; // remaining bursts (front is the current burst)
-    int executed_cpu{0};
-    int executed_io{0};
-    int total_cpu{0};
-    int total_io{0};
-    int completion_time{-1};
+    // Add the processes arena holds beyond the ones already in the table
+    void append(const BurstSpan& arena) {
+        size_t first = size(), n = arena.size();
+        cursor.insert(cursor.end(), arena.offsets + first, arena.offsets + n);
+        remaining.resize(n);
+        for (size_t i = first; i < n; ++i) remaining[i] = arena.bursts[cursor[i]];
+        executed_cpu.resize(n, 0);
+        executed_io.resize(n, 0);
+        completion_time.resize(n, -1);
+    }
 };
 
-enum class Strategy { FCFS, RR };
+// SJF and SRTF run the process with the least CPU left in its current burst; SRTF
+// also preempts the running one for a shorter one coming back from IO
+enum class Strategy { FCFS, RR, SJF, SRTF };
+
+// Blocked queue backend, see blocked_queue.h
+enum class Engine { HEAP, WHEEL };
+
+// Where an idle core with nothing queued of its own looks for work (-b)
+enum class Balance { NONE, NEIGHBOR, BUSIEST };
+
+// Log sink, see sinks.h
+enum class Output { TEXT, TRACE, CHROME, COUNT, NONE };
 
 struct Options {
     Strategy strategy{Strategy::FCFS};
     int quantum{2};
+    Engine engine{Engine::HEAP};
+    unsigned cores{1};                  // -c N: simulated CPUs
+    Balance balance{Balance::NEIGHBOR}; // -b: work stealing between them
+    unsigned sim_threads{1};            // -T N: simulate the cores on N threads, 0 for one per host CPU
+    bool pipeline{false}; // simulate while the file is still being parsed
+    bool convert{false};  // --convert: write file as a binary trace to output
     std::string file;
+    std::string output;
+    std::vector<std::string> files; // every operand; more than one, or a directory, is a batch
+    // --sweep: one run per strategy and quantum in these lists, e.g. "fcfs,rr" and "1..64"
+    bool sweep{false};
+    std::string strategies{"fcfs"};
+    std::string quanta{"2"};
+    Output sink{Output::TEXT};
+    unsigned format_threads{1}; // -f N: format the text on N threads, 0 for one per core
+    std::string trace;    // -t: write a binary event trace here instead of text
+    std::string timeline; // -j: write a Chrome trace JSON timeline here instead of text
+    // Which execution events are logged; completions and the input echo always are
+    bool events{true};            // -l summary turns them all off
+    int sample_every{1};          // -n N: only every Nth of them
+    std::vector<uint32_t> pids;   // -P a,b,c: only these processes (sorted), empty for all
 };
 
 struct Shared {
     std::atomic<bool> done{false};
+    std::mutex mu;
+    std::condition_variable finished;
+
+    // Scheduler side, last thing it does: set done and wake the wait loop. The
+    // notify happens under the lock, so the loop cannot see done and tear this
+    // down before it returns
+    void set_done() {
+        std::lock_guard<std::mutex> lock(mu);
+        done.store(true);
+        finished.notify_one();
+    }
+    // Wait loop side: sleep until done is set, or for timeout at most
+    void wait_done(std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mu);
+        finished.wait_for(lock, timeout, [this] { return done.load(); });
+    }
 };
 
 // -- Utility printing --
-static std:: string join_line_readable(const std::vector<int>& v) {
+static std:: string join_line_readable(const int* v, size_t n) {
     std:: ostringstream out;
-    for (size_t i = 0; i < v.size(); ++ i) {
+    for (size_t i = 0; i < n; ++ i) {
         int x = v[i];
         if (i) out << ", ";
         out << x << "ms (" << (i % 2 == 0 ? "CPU" : "IO") << ")";
@@ -73,16 +147,32 @@ static void exit_ok() {
     std::exit(0);
 }
 
+static bool is_directory(const std::string& path) {
+    DIR* d = opendir(path.c_str());
+    if (!d) return false;
+    closedir(d);
+    return true;
+}
+
 static Options parse_args(int argc, char** argv) {
     Options opt;
     opterr = 0; // Handle errors
     int c;
-    while ((c = getopt(argc, argv, "s:q:")) != -1) {
+    std::string single_run; // last option given that only a single run has a use for
+    static const struct option long_opts[] = {
+        {"convert", no_argument, nullptr, 'C'},
+        {"sweep", no_argument, nullptr, 'W'},
+        {nullptr, 0, nullptr, 0},
+    };
+    while ((c = getopt_long(argc, argv, "s:q:e:c:b:T:pt:j:o:f:l:n:P:", long_opts, nullptr)) != -1) {
         switch (c) {
             case 's': {
                 std::string v (optarg ? optarg: "");
+                opt.strategies = v;
                 if (v == "fcfs") opt.strategy = Strategy::FCFS;
                 else if (v == "rr") opt.strategy = Strategy::RR;
+                else if (v == "sjf") opt.strategy = Strategy::SJF;
+                else if (v == "srtf") opt.strategy = Strategy::SRTF;
                 else {
                     // Make the invalid strategy -> default to FCFS
                     opt.strategy = Strategy::FCFS;
@@ -97,190 +187,454 @@ static Options parse_args(int argc, char** argv) {
                     exit_ok();
                 }
                 opt.quantum = (int)val;
+                opt.quanta = optarg;
                 break;
         }
+        case 'e': {
+            std::string v (optarg ? optarg: "");
+            // Unknown engines fall back to the heap, like unknown strategies fall back to FCFS
+            opt.engine = (v == "wheel") ? Engine::WHEEL : Engine::HEAP;
+            break;
+        }
+        case 'c': {
+            char *end = nullptr; long val = std::strtol(optarg, &end, 10);
+            if (end == optarg || val <= 0 || val > INT16_MAX) {
+                std::cout << "Core count must be a number from 1 to " << INT16_MAX << "\n";
+                exit_ok();
+            }
+            opt.cores = (unsigned)val;
+            break;
+        }
+        case 'b': {
+            std::string v (optarg ? optarg: "");
+            // Unknown policies fall back to stealing from the next core
+            if (v == "none") opt.balance = Balance::NONE;
+            else if (v == "busiest") opt.balance = Balance::BUSIEST;
+            else opt.balance = Balance::NEIGHBOR;
+            break;
+        }
+        case 'T': {
+            char *end = nullptr; long val = std::strtol(optarg, &end, 10);
+            if (end == optarg || val < 0) {
+                std::cout << "Simulation threads must be a number and not negative\n";
+                exit_ok();
+            }
+            opt.sim_threads = val ? (unsigned)val : std::max(1u, std::thread::hardware_concurrency());
+            break;
+        }
+        case 'p':
+            opt.pipeline = true;
+            single_run = "-p";
+            break;
+        case 'C':
+            opt.convert = true;
+            break;
+        case 'W':
+            opt.sweep = true;
+            break;
+        case 't':
+            opt.trace = optarg ? optarg : "";
+            opt.sink = Output::TRACE;
+            single_run = "-t";
+            break;
+        case 'j':
+            opt.timeline = optarg ? optarg : "";
+            opt.sink = Output::CHROME;
+            single_run = "-j";
+            break;
+        case 'o': {
+            std::string v (optarg ? optarg: "");
+            single_run = "-o";
+            // Unknown sinks fall back to text
+            if (v == "count") opt.sink = Output::COUNT;
+            else if (v == "null") opt.sink = Output::NONE;
+            else opt.sink = Output::TEXT;
+            break;
+        }
+        case 'f': {
+            char *end = nullptr; long val = std::strtol(optarg, &end, 10);
+            if (end == optarg || val < 0) {
+                std::cout << "Format threads must be a number and not negative\n";
+                exit_ok();
+            }
+            opt.format_threads = val ? (unsigned)val : std::max(1u, std::thread::hardware_concurrency());
+            single_run = "-f";
+            break;
+        }
+        case 'l': {
+            std::string v (optarg ? optarg: "");
+            // Anything but summary keeps the full log
+            opt.events = (v != "summary");
+            single_run = "-l";
+            break;
+        }
+        case 'n': {
+            char *end = nullptr; long val = std::strtol(optarg, &end, 10);
+            if (end == optarg || val <= 0) {
+                std::cout << "Sample interval must be a number and bigger than 0\n";
+                exit_ok();
+            }
+            opt.sample_every = (int)val;
+            single_run = "-n";
+            break;
+        }
+        case 'P': {
+            std::stringstream list(optarg ? optarg : "");
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                char *end = nullptr; long val = std::strtol(item.c_str(), &end, 10);
+                if (end == item.c_str() || *end != '\0' || val < 0) {
+                    std::cout << "Process ids must be numbers separated by commas\n";
+                    exit_ok();
+                }
+                opt.pids.push_back((uint32_t)val);
+            }
+            std::sort(opt.pids.begin(), opt.pids.end());
+            single_run = "-P";
+            break;
+        }
         default:
             break;
     }
 }
-if (optind >= argc) {
-    std::cout << "Usage: " << argv[0] << " [-s fcfs|rr] [-q N] <bursts-file>\n";
+if (optind + (opt.convert ? 1 : 0) >= argc) {
+    std::cout << "Usage: " << argv[0] << " [-s fcfs|rr|sjf|srtf] [-q N] [-e heap|wheel] [-c N] [-b none|neighbor|busiest] [-T N] [-p] [-t trace-file] [-j json-file] [-o text|count|null] [-f N] [-l all|summary] [-n N] [-P pid,...] <bursts-file>\n"
+              << "       " << argv[0] << " [-s fcfs|rr|sjf|srtf] [-q N] [-e heap|wheel] [-c N] [-b policy] <bursts-file|directory>...\n"
+              << "       " << argv[0] << " --sweep [-s fcfs,rr,sjf,srtf] [-q N..M,...] [-e heap|wheel] [-c N] [-b policy] <bursts-file>\n"
+              << "       " << argv[0] << " --convert <bursts-file> <binary-file>\n";
     exit_ok();
 }
 opt.file = argv[optind];
+if (opt.convert) opt.output = argv[optind + 1];
+opt.files.assign(argv + optind, argv + argc);
+// A batch or a sweep prints nothing but its summary table, from input parsed up front
+bool batch = !opt.convert && (opt.files.size() > 1 || is_directory(opt.file));
+if (batch && (opt.sweep || !single_run.empty())) {
+    std::cout << "Option " << (opt.sweep ? "--sweep" : single_run) << " does not apply to a batch of files\n";
+    exit_ok();
+}
+if (opt.sweep && !single_run.empty()) {
+    std::cout << "Option " << single_run << " does not apply to --sweep\n";
+    exit_ok();
+}
+if (opt.cores > 1) {
+    // The cores of a multi-core run queue in arrival order (FIFO rings)
+    bool shortest_first = opt.strategy == Strategy::SJF || opt.strategy == Strategy::SRTF;
+    std::stringstream list(opt.sweep ? opt.strategies : "");
+    std::string item;
+    while (std::getline(list, item, ',')) shortest_first = shortest_first || item == "sjf" || item == "srtf";
+    if (shortest_first) {
+        std::cout << "Strategies sjf and srtf run on a single core\n";
+        exit_ok();
+    }
+}
 return opt;
 }
 
-static std::vector<BurstLine> read_bursts(const std::string& path) {
-    std::ifstream fin(path);
-    if (!fin) {
-        std::cout << "Unable to open <" << path << ">\n";
-        exit_ok();
+static std::string burst_error_message(BurstError err, const std::string& path) {
+    switch (err) {
+        case BurstError::NONE:
+            break;
+        case BurstError::OPEN_FAILED:
+            return "Unable to open <" + path + ">";
+        case BurstError::NON_POSITIVE:
+            return "A burst number must be bigger than 0";
+        case BurstError::EVEN_COUNT:
+            return "There must be an odd number of bursts for each process";
+        case BurstError::BAD_BINARY:
+            return "Invalid binary burst file <" + path + ">";
     }
-    std::vector<BurstLine> lines;
-    std::string line;
-    while (std::getline(fin, line)) {
-        if (line.empty()) continue;
-        std::istringstream iss(line);
-        int x; BurstLine bl;
-        while (iss >> x) {
-            if (x <= 0) {
-                std::cout << "A burst number must be bigger than 0\n";
-                exit_ok();
-            }
-            bl.bursts.push_back(x);
-        }
-        if (!bl.bursts.empty() && (bl.bursts.size() % 2 == 0)) {
-            std::cout << "There must be an odd number of bursts for each process\n";
-            exit_ok();
-        }
-        if (!bl.bursts.empty()) lines.push_back(std::move(bl));
+    return "";
 }
-return lines;
+
+static void report_burst_error(BurstError err, const std::string& path) {
+    if (err == BurstError::NONE) return;
+    std::cout << burst_error_message(err, path) << "\n";
+    exit_ok();
 }
 
-// -- Scheduler Core --
-struct BlockedItem { Proc* p; int remaining_io; size_t order; }; // Order for stability
+// Text or binary, detected by the magic number
+static void read_bursts(const std::string& path, BurstFile& file) {
+    report_burst_error(file.open(path), path);
+}
 
-static void stable_sort_blocked(std::deque<BlockedItem>& blocked) {
-    std::stable_sort(blocked.begin(), blocked.end(), [](const BlockedItem& a, const BlockedItem& b) {
-        if (a.remaining_io != b.remaining_io) return a.remaining_io < b.remaining_io;
-        return a.order < b.order;
-    });
+static void echo_bursts(const BurstSpan& lines) {
+    for (size_t i = 0; i < lines.size(); ++ i) {
+        log_process_bursts((unsigned int*)lines.line(i), lines.line_size(i));
+    }
 }
 
+// -- Scheduler Core --
+template <typename Sink, typename BlockedQueue>
 struct Simulation {
     Options opt;
     Shared* shared;
+    Sink& sink;           // see sinks.h
     int time_elapsed{0};
-    std::queue<Proc*> ready;
-    std::deque<BlockedItem> blocked;
-    std::vector<Proc> procs;
+    IndexRing ready;
+    IndexHeap shortest;   // the ready queue instead, for SJF and SRTF
+    BlockedQueue blocked; // HeapBlockedQueue or TimingWheelBlockedQueue
+    BurstSpan input;
+    ProcTable procs;
     std::vector<std::pair<int, int>> completed; // (completion_time, pid)
-    size_t order_counter{0};
 
-    explicit Simulation(const Options& o, Shared* s): opt(o), shared(s) {}
+    // Every process is admitted at time 0 in file order, so processes that have not
+    // run yet are always ahead of anything re-entering the ready queue: they are
+    // dispatched from next_initial onwards before the ring is consulted.
+    uint32_t next_initial{0};
 
-    void init_from_lines(const std::vector<BurstLine>& lines) {
-        procs.clear();
-        for (size_t i = 0; i < lines.size(); ++i) {
-            Proc p; p.pid = (int)i; p.bursts = std::deque<int>(lines[i].bursts.begin(), lines[i].bursts.end());
-            // sum cpu/io totals for stats
-            for (size_t k = 0; k < lines[i].bursts.size(); ++k) {
-                if (k % 2 == 0) p.total_cpu += lines[i].bursts[k];
-                else p.total_io += lines[i].bursts[k];
+    // Pipelined admission (-p): the table and arena grow as the parser delivers chunks.
+    // All output waits until the whole file is known to be valid, since the echo of
+    // the input comes first. The events logged until then are kept in a block of
+    // DEFERRED_BLOCK records, and each full block goes to an unnamed temporary file,
+    // so holding them back takes no more memory however long the input is.
+    static const size_t DEFERRED_BLOCK = 1 << 16;
+    BurstStream* stream{nullptr};
+    BurstArena streamed;             // owns the input in pipelined mode
+    std::vector<LogRecord> deferred; // events logged before the input was complete
+    FILE* spill{nullptr};            // the ones before those
+    size_t spilled{0};               // records in spill
+    bool spill_failed{false};        // no temporary file: deferred just grows
+
+    Simulation(const Options& o, Shared* s, Sink& k): opt(o), shared(s), sink(k) {}
+    ~Simulation() {
+        if (spill) std::fclose(spill);
+    }
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // The arena is borrowed, not copied, and must outlive the simulation
+    void init_from_lines(const BurstSpan& lines) {
+        input = lines;
+        procs.assign(lines);
+        // Only the queue the strategy uses gets room for every process
+        if (shortest_first()) {
+            // Everything arrives at 0 but leaves the queue in length order
+            ready.reset(0);
+            shortest.reset(procs.size());
+            for (uint32_t p = 0; p < procs.size(); ++p) shortest.push(p, procs.remaining[p]);
+            next_initial = (uint32_t)procs.size();
+        } else {
+            ready.reset(procs.size());
+        }
+        // The input is already validated, so its echo goes out first
+        sink.echo(&input);
+    }
+
+    void init_from_stream(BurstStream& s) {
+        stream = &s;
+        input = streamed.span();
+        ready.reset(0);
+    }
+
+    // Wait for the parser to deliver the next chunk; at the end of the input either
+    // report the error or release the echo and everything logged so far
+    void admit_chunk() {
+        BurstArena chunk;
+        if (!stream -> next(chunk)) {
+            report_burst_error(stream -> error(), opt.file);
+            stream = nullptr;
+            // input is final from here on
+            sink.echo(&input);
+            replay_deferred();
+            return;
+        }
+        if (streamed.bursts.size() + chunk.bursts.size() > streamed.bursts.capacity() ||
+            streamed.offsets.size() + chunk.size() > streamed.offsets.capacity()) {
+            reserve_for_file(chunk);
+        }
+        size_t base = streamed.bursts.size();
+        streamed.bursts.insert(streamed.bursts.end(), chunk.bursts.begin(), chunk.bursts.end());
+        for (size_t i = 1; i < chunk.offsets.size(); ++i) streamed.offsets.push_back(base + chunk.offsets[i]);
+        input = streamed.span();
+        procs.append(input);
+        ready.reserve(procs.size());
+    }
+
+    // Size the arena, table and ready queue for the whole file, extrapolated from how
+    // much the chunks so far hold per byte, rather than letting them double: every
+    // doubling holds the old and the new copy at once. An estimate that falls short
+    // is extended the same way at the next chunk that does not fit.
+    void reserve_for_file(const BurstArena& chunk) {
+        size_t bytes = std::max<size_t>(stream -> delivered(), 1), total = stream -> size();
+        auto estimate = [&](size_t have) {
+            size_t n = (size_t)((double)have * total / bytes);
+            return n + n / 16 + 1024;
+        };
+        size_t bursts = estimate(streamed.bursts.size() + chunk.bursts.size());
+        size_t lines = estimate(streamed.size() + chunk.size());
+        streamed.bursts.reserve(bursts);
+        streamed.offsets.reserve(lines + 1);
+        procs.reserve(lines);
+        ready.reserve(lines);
+    }
+
+    bool shortest_first() const { return opt.strategy == Strategy::SJF || opt.strategy == Strategy::SRTF; }
+
+    bool has_ready() {
+        while (stream && next_initial == procs.size()) admit_chunk();
+        return next_initial < procs.size() || !ready.empty() || !shortest.empty();
+    }
+
+    uint32_t pop_ready() {
+        if (shortest_first()) return shortest.pop();
+        if (next_initial < procs.size()) return next_initial++;
+        return ready.pop();
+    }
+
+    // Whether the execution event p is about to produce gets logged (sink, -l, -n, -P).
+    // Checked at the call site, so a skipped event costs no more than this test, and
+    // nothing at all with a sink that takes no execution events.
+    uint64_t events_seen{0};
+    bool sampled(uint32_t p) {
+        if (!Sink::enabled || !opt.events) return false;
+        if (!opt.pids.empty() && !std::binary_search(opt.pids.begin(), opt.pids.end(), p)) return false;
+        return events_seen++ % (uint64_t)opt.sample_every == 0;
+    }
+
+    void log_execution(uint32_t p, ExecutionStopReasonType reason) {
+        LogRecord r = LogRecord::execution(p, procs.executed_cpu[p], procs.executed_io[p], time_elapsed, reason, NO_CORE);
+        if (stream) {
+            deferred.push_back(r);
+            if (deferred.size() % DEFERRED_BLOCK == 0) spill_deferred();
+        } else {
+            sink.execution(p, r.cpu, r.io, r.elapsed, reason, NO_CORE);
+        }
+    }
+
+    // Move the deferred block out to the temporary file. The block is flushed as a
+    // whole, and if that fails the file is cut back to the blocks before it and the
+    // records stay in memory instead.
+    void spill_deferred() {
+        if (spill_failed) return;
+        if (!spill) spill = std::tmpfile();
+        size_t n = deferred.size();
+        if (spill && std::fwrite(deferred.data(), sizeof(LogRecord), n, spill) == n && std::fflush(spill) == 0) {
+            spilled += n;
+            deferred.clear();
+            return;
+        }
+        spill_failed = true;
+        if (spill) std::fseek(spill, (long)(spilled * sizeof(LogRecord)), SEEK_SET);
+    }
+
+    // Log everything deferred, in order: the spilled blocks, then what is in memory
+    void replay_deferred() {
+        if (spill) {
+            std::rewind(spill);
+            std::vector<LogRecord> block(DEFERRED_BLOCK);
+            for (size_t left = spilled; left > 0;) {
+                size_t n = std::fread(block.data(), sizeof(LogRecord), std::min(left, block.size()), spill);
+                if (n == 0) break;
+                for (size_t i = 0; i < n; ++i) replay(block[i]);
+                left -= n;
             }
-            procs.push_back(std::move(p));
+            std::fclose(spill);
+            spill = nullptr;
         }
-        for (auto& p: procs) ready.push(&p);
+        for (const LogRecord& r : deferred) replay(r);
+        std::vector<LogRecord>().swap(deferred);
     }
 
-    void print_input_readback(const std::vector<BurstLine>& lines) {
+    void replay(const LogRecord& r) {
+        sink.execution(r.pid, r.cpu, r.io, r.elapsed, (ExecutionStopReasonType)r.reason, r.core);
+    }
+
+    void print_input_readback(const BurstSpan& lines) {
         for (size_t i = 0; i < lines.size(); ++ i) {
-            std::cout << "P" << i << ": " << join_line_readable(lines[i].bursts) << "\n";
-        }
-    }
-
-    void enqueue_ready(Proc* p) { ready.push(p); }
-
-    void move_to_blocked(Proc* p) {
-        // Pop finished CPU burst
-        if (!p -> bursts.empty() && p -> bursts.front() == 0) p -> bursts.pop_front();
-        if (!p -> bursts.empty()) {
-            // now front is IO burst
-            int io = p -> bursts.front();
-            blocked.push_back(BlockedItem{p, io, order_counter++});
-            stable_sort_blocked(blocked);
-        }
-    }
-
-    // Advance all blocked by dt; move any finished (in ascending remaining order) to ready immeediately
-    void advance_blocked(int dt) {
-        int t = dt;
-        while (t > 0 && !blocked.empty()) {
-            stable_sort_blocked(blocked);
-            int next_finish = blocked.front().remaining_io;
-            int step = std::min(next_finish, t);
-            for (auto &bi : blocked) {
-                int dec = std::min(step, bi.remaining_io);
-                bi.remaining_io -= dec;
-                bi.p->executed_io += dec;
-            }
-            t -= step;
-            // move all that hit 0 in the order of the current ordering
-            std::deque<BlockedItem> remaining;
-            for (auto &bi : blocked) {
-                if (bi.remaining_io == 0) {
-                    // consume IO burst and push to ready
-                    if (!bi.p -> bursts.empty()) {
-                        // remove the IO burst front
-                        bi.p -> bursts.pop_front();
-                    }
-                    enqueue_ready(bi.p);
-                } else {
-                    remaining.push_back(bi);
-                }
-            }
-            blocked.swap(remaining);
+            std::cout << "P" << i << ": " << join_line_readable(lines.line(i), lines.line_size(i)) << "\n";
         }
-        // if t > 0 and not blocked, nothing to do
-        if (t > 0) {
-            // no blocked to progress; nothing else to update
+    }
+
+    void enqueue_ready(uint32_t p) {
+        if (shortest_first()) shortest.push(p, procs.remaining[p]);
+        else ready.push(p);
+    }
+
+    // Step p onto its next burst; false once it has none left
+    bool next_burst(uint32_t p) {
+        size_t c = ++procs.cursor[p];
+        if (c == input.offsets[p + 1]) return false;
+        procs.remaining[p] = input.bursts[c];
+        return true;
+    }
+
+    // The current burst of p is IO, wake up once it has fully elapsed
+    void move_to_blocked(uint32_t p) {
+        if (Sink::timeline) sink.blocked(p, time_elapsed, time_elapsed + procs.remaining[p]);
+        blocked.push(p, time_elapsed + procs.remaining[p]);
+    }
+
+    // SRTF: how much of segment runs before a process comes back from IO with less CPU
+    // left than the running one will have by then. Releases the IO that completes
+    // before that, in wake order; each wake is a heap push and a look at the top.
+    int until_preempted(int segment) {
+        int start = time_elapsed, end = start + segment;
+        while (!blocked.empty() && blocked.next_wake() < end) {
+            time_elapsed = blocked.next_wake();
+            advance_blocked();
+            if (shortest.top_key() < end - time_elapsed) {
+                end = time_elapsed;
+                break;
+            }
         }
+        time_elapsed = start;
+        return end - start;
+    }
+
+    // Move every blocked process whose IO is done by time_elapsed to ready, earliest (then FIFO) first.
+    // Blocked items are never touched while waiting; executed_io is settled only when one wakes up
+    void advance_blocked() {
+        blocked.pop_due(time_elapsed, [this](uint32_t p) {
+            // consume IO burst and push to ready
+            procs.executed_io[p] += procs.remaining[p];
+            next_burst(p);
+            enqueue_ready(p);
+        });
 }
 
 void run() {
     while(true) {
-        if (!ready.empty()) {
-            Proc* p = ready.front(); ready.pop();
+        if (has_ready()) {
+            uint32_t p = pop_ready();
             // Amount this CPU segment can run
-            int cpu_remaining = p -> bursts.front();
-            int segment = (opt.strategy == Strategy::FCFS) ? cpu_remaining : std::min(cpu_remaining, opt.quantum);
-
-            // Execute in multiple sub-steps due to blocked finishes
-            int remaining = segment;
-            while (remaining > 0) {
-                int step = remaining;
-                if (!blocked.empty()) {
-                    stable_sort_blocked(blocked);
-                    int soonest = blocked.front().remaining_io;
-                    if (soonest > 0) step = std::min(step, soonest);
-                }
-                // Apply step
-                p -> executed_cpu += step;
-                time_elapsed += step;
-                p -> bursts.front() -= step;
-                // Progress blocked by step
-                advance_blocked(step);
-                remaining -= step;
-            }
+            int cpu_remaining = procs.remaining[p];
+            int segment = (opt.strategy == Strategy::RR) ? std::min(cpu_remaining, opt.quantum) : cpu_remaining;
+            if (opt.strategy == Strategy::SRTF) segment = until_preempted(segment);
+
+            // time_elapsed is the global clock: the whole segment is one jump. IO that
+            // completed meanwhile is released in wake order, exactly as if we had stepped
+            procs.executed_cpu[p] += segment;
+            procs.remaining[p] -= segment;
+            time_elapsed += segment;
+            if (Sink::timeline) sink.segment(0, p, time_elapsed - segment, time_elapsed);
+            advance_blocked();
 
             // Determine the reason we stopped and take actions
-            if (p -> bursts.front() == 0) {
+            if (procs.remaining[p] == 0) {
                 // Finished CPU burst
-                p -> bursts.pop_front();
-                if (p -> bursts.empty()) {
+                if (!next_burst(p)) {
                     // Completed all bursts
-                    p -> completion_time = time_elapsed;
-                    completed.push_back({time_elapsed, p -> pid});
-                    log_cpuburst_execution(p -> pid, p -> executed_cpu, p -> executed_io, time_elapsed, COMPLETED);
+                    procs.completion_time[p] = time_elapsed;
+                    completed.push_back({time_elapsed, (int)p});
+                    if (sampled(p)) log_execution(p, COMPLETED);
                 } else {
                     // Enter IO
-                    log_cpuburst_execution(p -> pid, p -> executed_cpu, p -> executed_io, time_elapsed, ENTER_IO);
+                    if (sampled(p)) log_execution(p, ENTER_IO);
                     move_to_blocked(p);
                 }
             } else {
-                // Quantum expired
-                log_cpuburst_execution(p -> pid, p -> executed_cpu, p -> executed_io, time_elapsed, QUANTUM_EXPIRED);
+                // Quantum expired, or preempted by SRTF
+                if (sampled(p)) log_execution(p, QUANTUM_EXPIRED);
                 enqueue_ready(p);
             }
+            // Processes not dispatched yet count as ready
+            if (Sink::timeline) sink.queues(time_elapsed, procs.size() - next_initial + ready.size() + shortest.size(), blocked.size());
         } else if (!blocked.empty()) {
             // No ready tasks; jump time until the earliest IO completes
-            stable_sort_blocked(blocked);
-            int step = blocked.front().remaining_io;
-            // Progress all blocked by 'step' and move those that finish
-            advance_blocked(step);
-            time_elapsed += step; // Advancing wall time while CPU idle
+            time_elapsed = blocked.next_wake(); // Advancing wall time while CPU idle
+            // Move those that finish to ready
+            advance_blocked();
         } else {
             // Both empty -> done
             break;
@@ -292,53 +646,936 @@ void run() {
         // Order by completion time (already appended in order of time_elapsed increases)
         std::stable_sort(completed.begin(), completed.end());
         for (auto [t, pid] : completed) {
-            const Proc& p = procs[pid];
-            int turnaround = p.completion_time; // Admitted at 0
-            int wait = turnaround - (p.total_cpu + p.total_io);
-            log_process_completion(pid, turnaround, wait);
+            int turnaround = procs.completion_time[pid]; // Admitted at 0
+            // sum cpu/io totals for stats
+            const int* b = input.line(pid);
+            int total = std::accumulate(b, b + input.line_size(pid), 0);
+            int wait = turnaround - total;
+            sink.completion(pid, turnaround, wait);
+        }
+        sink.finish();
+    }
+};
+
+// -- Multi-core scheduler (-c N) --
+// N CPUs, each with its own FIFO ready queue. The processes are split over the
+// cores in file order, core c starting with the c-th of N equal blocks (give or
+// take one process); one whose quantum expires, or that comes back from
+// IO, is queued on the core it last ran on. An idle core runs the front of its
+// own queue or, when that is empty, steals the front of another core's queue as
+// -b says:
+//   none      never
+//   neighbor  from the next core after it with work queued, wrapping around
+//   busiest   from the core with the longest queue, the lowest one on ties
+// Simultaneous events are handled in a fixed order, so runs are reproducible: IO
+// completions first (in wake order), then the segments that end, in core order,
+// then the idle cores take work in core order, all from their own queues before
+// any steal. With one core this is exactly Simulation.
+// An event costs O(log n) in the blocked queue and O(log cores) in the heap of
+// running segments; idle and queued cores are bitmaps, so an idle core finds work
+// in a word scan (busiest compares the queue lengths of the cores that have any).
+//
+// The cores are split into partitions of consecutive cores, one per host thread
+// (-T). A partition keeps its own clock, the queues of its cores and the processes
+// blocked in IO that will come back to them, so partitions only ever interact when
+// a core steals. That makes a conservative parallel simulation with a time-window
+// barrier. While every core is busy, a core with k processes queued behind a
+// segment that ends at e cannot run dry before e + k * L, L being the shortest
+// segment any burst can give (the lookahead), so no steal can happen before the
+// earliest of those times over all cores. While some core is idle nothing is
+// queued anywhere, and nothing will be until a process comes back from IO: no
+// sooner than the earliest wake, or the earliest segment end plus the shortest IO
+// burst. Every partition simulates up to that horizon on its own thread; once it
+// is reached, events are handled one event time at a time on the scheduler thread
+// until there is a horizon ahead again. The execution events of a window are
+// buffered per partition and merged in (time, core) order, so the output is
+// exactly that of a single partition. Timeline runs (-j) use one partition.
+template <typename Sink, typename BlockedQueue>
+struct MultiCoreSimulation : Simulation<Sink, BlockedQueue> {
+    using Base = Simulation<Sink, BlockedQueue>;
+    using Base::opt; using Base::sink; using Base::input; using Base::procs; using Base::completed;
+    using Base::sampled; using Base::next_burst;
+
+    struct Core {
+        uint32_t proc; // running process, unless the core is idle
+        int segment;   // how long it runs for
+        int end;       // when it is done
+    };
+    using Running = std::pair<int, uint32_t>; // (segment end, core in the partition)
+
+    // Cores [first, first + cores.size()); everything indexed by core is indexed
+    // from first. Only its own thread touches a partition during a window, and only
+    // the scheduler thread between windows.
+    struct Partition {
+        MultiCoreSimulation* sim{nullptr};
+        uint32_t first{0};
+        std::vector<Core> cores;
+        std::vector<IndexRing> queues;   // ready queue of each core
+        CoreSet idle;
+        CoreSet queued;                  // cores with a nonempty ready queue
+        size_t idle_cores{0};
+        size_t queued_cores{0};
+        size_t ready_count{0};           // processes in all the ready queues
+        std::vector<Running> running;    // min-heap: earliest end, then lowest core
+        BlockedQueue blocked;            // processes that come back to these cores
+        int time{0};
+        std::vector<std::pair<int, int>> completed; // (completion_time, pid)
+        bool buffered{false};            // execution events go to events, not the sink
+        std::vector<LogRecord> events;
+
+        void init(MultiCoreSimulation* s, uint32_t from, uint32_t count, size_t queue_size) {
+            sim = s;
+            first = from;
+            cores.assign(count, Core{0, 0, 0});
+            queues.resize(count);
+            idle.reset(count);
+            queued.reset(count);
+            idle_cores = count;
+            for (uint32_t i = 0; i < count; ++i) {
+                idle.insert(i);
+                // Queues grow if balancing piles more than this onto one core
+                queues[i].reset(queue_size);
+            }
+        }
+
+        void push_ready(uint32_t i, uint32_t p) {
+            IndexRing& q = queues[i];
+            if (q.size() == q.capacity()) q.reserve(q.size() + 1);
+            q.push(p);
+            if (q.size() == 1) {
+                queued.insert(i);
+                ++queued_cores;
+            }
+            ++ready_count;
+        }
+
+        uint32_t pop_ready(uint32_t i) {
+            IndexRing& q = queues[i];
+            uint32_t p = q.pop();
+            if (q.empty()) {
+                queued.erase(i);
+                --queued_cores;
+            }
+            --ready_count;
+            return p;
+        }
+
+        void log_execution(uint32_t i, uint32_t p, ExecutionStopReasonType reason) {
+            if (!Sink::enabled || !sim -> opt.events) return;
+            const ProcTable& procs = sim -> procs;
+            if (!buffered) {
+                if (sim -> sampled(p)) {
+                    sim -> sink.execution(p, procs.executed_cpu[p], procs.executed_io[p], time, reason, (int)(first + i));
+                }
+                return;
+            }
+            // Sampled once merged, in output order; the process filter can go first
+            const std::vector<uint32_t>& pids = sim -> opt.pids;
+            if (!pids.empty() && !std::binary_search(pids.begin(), pids.end(), p)) return;
+            events.push_back(LogRecord::execution(p, procs.executed_cpu[p], procs.executed_io[p], time, reason,
+                                                  (int)(first + i)));
+        }
+
+        // Put p on core i from now to the end of its segment, returns when that is
+        int assign(uint32_t i, uint32_t p) {
+            int cpu_remaining = sim -> procs.remaining[p];
+            int segment = (sim -> opt.strategy == Strategy::FCFS) ? cpu_remaining : std::min(cpu_remaining, sim -> opt.quantum);
+            cores[i] = Core{p, segment, time + segment};
+            sim -> home[p] = (uint16_t)(first + i);
+            if (Sink::timeline) sim -> sink.segment((int)(first + i), p, time, time + segment);
+            return time + segment;
+        }
+
+        // Run p on idle core i
+        void start(uint32_t i, uint32_t p) {
+            idle.erase(i);
+            --idle_cores;
+            running.push_back(Running{assign(i, p), i});
+            std::push_heap(running.begin(), running.end(), std::greater<Running>());
+        }
+
+        // Idle cores with a queue of their own take its front
+        void dispatch_own() {
+            if (!idle_cores || !queued_cores) return;
+            for (uint32_t i = CoreSet::next_common(idle, queued, 0); i != CoreSet::NONE;
+                 i = CoreSet::next_common(idle, queued, i + 1)) {
+                start(i, pop_ready(i));
+            }
+        }
+
+        // Simulation::advance_blocked, queueing each process on its own core
+        void advance_blocked() {
+            blocked.pop_due(time, [this](uint32_t p) {
+                ProcTable& procs = sim -> procs;
+                procs.executed_io[p] += procs.remaining[p];
+                sim -> next_burst(p);
+                push_ready(sim -> home[p] - first, p);
+            });
+        }
+
+        // The segment on core i ends now
+        void finish(uint32_t i) {
+            ProcTable& procs = sim -> procs;
+            uint32_t p = cores[i].proc;
+            procs.executed_cpu[p] += cores[i].segment;
+            procs.remaining[p] -= cores[i].segment;
+            if (procs.remaining[p] == 0) {
+                if (!sim -> next_burst(p)) {
+                    procs.completion_time[p] = time;
+                    completed.push_back({time, (int)p});
+                    log_execution(i, p, COMPLETED);
+                } else {
+                    log_execution(i, p, ENTER_IO);
+                    if (Sink::timeline) sim -> sink.blocked(p, time, time + procs.remaining[p]);
+                    blocked.push(p, time + procs.remaining[p]);
+                }
+            } else {
+                log_execution(i, p, QUANTUM_EXPIRED);
+                push_ready(i, p);
+            }
+        }
+
+        // Earliest IO completion or segment end, INT_MAX if there is none
+        int next_event() const {
+            int t = running.empty() ? INT_MAX : running.front().first;
+            if (!blocked.empty()) t = std::min(t, blocked.next_wake());
+            return t;
+        }
+
+        // Move the clock to t and handle what happens then: IO completions, then the
+        // segments that end, in core order
+        void events_at(int t) {
+            time = t;
+            advance_blocked();
+            while (!running.empty() && running.front().first == time) {
+                uint32_t i = running.front().second;
+                std::pop_heap(running.begin(), running.end(), std::greater<Running>());
+                finish(i);
+                // A core with work of its own takes it now, as dispatch would have
+                // before any steal; the heap entry is reused for its next segment
+                if (!queues[i].empty()) {
+                    running.back().first = assign(i, pop_ready(i));
+                    std::push_heap(running.begin(), running.end(), std::greater<Running>());
+                } else {
+                    running.pop_back();
+                    idle.insert(i);
+                    ++idle_cores;
+                }
+            }
+        }
+
+        // Everything before end, with no steals (the caller makes sure none is due)
+        void run_until(int end) {
+            for (int t; (t = next_event()) < end;) {
+                events_at(t);
+                dispatch_own();
+            }
+        }
+
+        // Earliest time a core here could be left idle with nothing queued, assuming
+        // nothing is stolen from it before; only asked when no core is idle
+        int64_t busy_horizon(int64_t lookahead) const {
+            int64_t h = INT64_MAX;
+            for (size_t i = 0; i < cores.size(); ++i) {
+                h = std::min(h, cores[i].end + (int64_t)queues[i].size() * lookahead);
+            }
+            return h;
+        }
+
+        // Earliest time a process could come back from IO to a core here
+        int64_t wake_horizon(int64_t io_lookahead) const {
+            int64_t h = running.empty() ? INT64_MAX : running.front().first + io_lookahead;
+            if (!blocked.empty()) h = std::min(h, (int64_t)blocked.next_wake());
+            return h;
+        }
+    };
+
+    std::vector<Partition> partitions;
+    std::vector<uint16_t> home;      // core each process last ran on
+    int64_t lookahead{0};            // shortest possible CPU segment
+    int64_t io_lookahead{0};         // shortest IO burst
+    size_t window_events{1 << 16};   // buffered events per partition to aim a window at
+
+    MultiCoreSimulation(const Options& o, Shared* s, Sink& k): Base(o, s, k) {}
+    MultiCoreSimulation(const MultiCoreSimulation&) = delete;
+    MultiCoreSimulation& operator=(const MultiCoreSimulation&) = delete;
+
+    // The arena is borrowed, not copied, and must outlive the simulation
+    void init_from_lines(const BurstSpan& lines) {
+        input = lines;
+        procs.assign(lines);
+        size_t n = procs.size(), ncores = opt.cores;
+        // The timeline is written as the scheduler goes, so it needs one partition
+        size_t nparts = Sink::timeline ? 1 : std::max(1u, std::min(opt.sim_threads, opt.cores));
+        partitions.resize(nparts);
+        for (size_t k = 0; k < nparts; ++k) {
+            uint32_t from = (uint32_t)(k * ncores / nparts), to = (uint32_t)((k + 1) * ncores / nparts);
+            partitions[k].init(this, from, to - from, n / ncores + 1);
+            partitions[k].buffered = nparts > 1;
+        }
+        home.resize(n);
+        // Contiguous blocks rather than round-robin, so every core walks the process
+        // table in order instead of striding over the other cores' processes
+        for (uint32_t p = 0; p < n; ++p) {
+            uint32_t c = (uint32_t)((uint64_t)p * ncores / n);
+            Partition& part = partition_of(c);
+            home[p] = (uint16_t)c;
+            part.push_ready(c - part.first, p);
+        }
+        if (nparts > 1) find_lookahead();
+        sink.echo(&input);
+    }
+
+    Partition& partition_of(uint32_t c) {
+        size_t k = (size_t)(((uint64_t)c + 1) * partitions.size() - 1) / opt.cores;
+        return partitions[k];
+    }
+
+    // Shortest segment the strategy can cut out of any CPU burst, and shortest IO burst
+    void find_lookahead() {
+        lookahead = io_lookahead = INT_MAX;
+        for (size_t i = 0; i < input.size(); ++i) {
+            const int* b = input.line(i);
+            for (size_t j = 0; j < input.line_size(i); ++j) {
+                int s = b[j];
+                if (j % 2) {
+                    io_lookahead = std::min(io_lookahead, (int64_t)s);
+                    continue;
+                }
+                if (opt.strategy == Strategy::RR && s > opt.quantum) s = (s % opt.quantum) ? s % opt.quantum : opt.quantum;
+                lookahead = std::min(lookahead, (int64_t)s);
+            }
         }
     }
+
+    // Core to steal from for idle core c, as (partition, core in it); the partition
+    // is null if the policy finds none
+    std::pair<Partition*, uint32_t> victim(size_t k, uint32_t c) {
+        size_t nparts = partitions.size();
+        if (opt.balance == Balance::NEIGHBOR) {
+            // The rest of c's partition, the partitions after it, then the cores before c
+            for (size_t step = 0; step <= nparts; ++step) {
+                Partition& part = partitions[(k + step) % nparts];
+                uint32_t from = (step == 0) ? c - part.first + 1 : 0;
+                uint32_t v = part.queued.next(from);
+                if (v != CoreSet::NONE) return {&part, v};
+            }
+            return {nullptr, 0};
+        }
+        Partition* best = nullptr;
+        uint32_t best_core = 0;
+        for (Partition& part : partitions) {
+            for (uint32_t v = part.queued.next(0); v != CoreSet::NONE; v = part.queued.next(v + 1)) {
+                if (!best || part.queues[v].size() > best -> queues[best_core].size()) {
+                    best = &part;
+                    best_core = v;
+                }
+            }
+        }
+        return {best, best_core};
+    }
+
+    // Put the idle cores to work: every one with a queue of its own first, then the
+    // rest steal, in core order, for as long as anything is queued
+    void dispatch() {
+        size_t idle_cores = 0, queued_cores = 0;
+        for (Partition& part : partitions) {
+            part.dispatch_own();
+            idle_cores += part.idle_cores;
+            queued_cores += part.queued_cores;
+        }
+        if (!idle_cores || opt.balance == Balance::NONE) return;
+        for (size_t k = 0; k < partitions.size() && queued_cores; ++k) {
+            Partition& part = partitions[k];
+            for (uint32_t i = part.idle.next(0); i != CoreSet::NONE && queued_cores; i = part.idle.next(i + 1)) {
+                std::pair<Partition*, uint32_t> v = victim(k, part.first + i);
+                size_t before = v.first -> queued_cores;
+                uint32_t p = v.first -> pop_ready(v.second);
+                queued_cores -= before - v.first -> queued_cores;
+                part.start(i, p);
+            }
+        }
+    }
+
+    // Hand the buffered execution events to the sink in (time, core) order, the
+    // order a single partition would have logged them in
+    void merge_events() {
+        if (!Sink::enabled || !opt.events || partitions.size() == 1) return;
+        std::vector<size_t> next(partitions.size(), 0);
+        while (true) {
+            Partition* from = nullptr;
+            size_t* at = nullptr;
+            for (size_t k = 0; k < partitions.size(); ++k) {
+                std::vector<LogRecord>& ev = partitions[k].events;
+                if (next[k] == ev.size()) continue;
+                if (!from || ev[next[k]].elapsed < from -> events[*at].elapsed) {
+                    from = &partitions[k];
+                    at = &next[k];
+                }
+            }
+            if (!from) break;
+            const LogRecord& r = from -> events[(*at)++];
+            if (sampled(r.pid)) sink.execution(r.pid, r.cpu, r.io, r.elapsed, (ExecutionStopReasonType)r.reason, r.core);
+        }
+        for (Partition& part : partitions) part.events.clear();
+    }
+
+    // Earliest next event over all partitions, INT_MAX once there are none
+    int next_event() const {
+        int t = INT_MAX;
+        for (const Partition& part : partitions) t = std::min(t, part.next_event());
+        return t;
+    }
+
+    // No steal can happen before the returned time
+    int64_t horizon() const {
+        if (opt.balance == Balance::NONE) return INT64_MAX;
+        size_t idle_cores = 0, queued_cores = 0;
+        for (const Partition& part : partitions) {
+            idle_cores += part.idle_cores;
+            queued_cores += part.queued_cores;
+        }
+        int64_t h = INT64_MAX;
+        if (!idle_cores) {
+            for (const Partition& part : partitions) h = std::min(h, part.busy_horizon(lookahead));
+        } else if (!queued_cores) {
+            for (const Partition& part : partitions) h = std::min(h, part.wake_horizon(io_lookahead));
+        } else {
+            h = 0; // dispatch leaves no such state behind, but be safe
+        }
+        return h;
+    }
+
+    // Handle time t across every partition, steals included
+    void step(int t) {
+        bool all_idle = true;
+        for (const Partition& part : partitions) all_idle = all_idle && part.running.empty();
+        for (Partition& part : partitions) part.events_at(t);
+        if (Sink::timeline && !all_idle) {
+            sink.queues(t, partitions[0].ready_count, partitions[0].blocked.size());
+        }
+        dispatch();
+        merge_events();
+    }
+
+    void run() {
+        dispatch();
+        if (partitions.size() == 1) {
+            for (int t; (t = next_event()) != INT_MAX;) step(t);
+        } else {
+            run_parallel();
+        }
+        for (Partition& part : partitions) completed.insert(completed.end(), part.completed.begin(), part.completed.end());
+    }
+
+    // Partition k > 0 runs on worker k; the scheduler thread runs partition 0 and
+    // the steps between windows
+    void run_parallel() {
+        std::mutex mu;
+        std::condition_variable start_cv, done_cv;
+        uint64_t generation = 0;
+        size_t pending = 0;
+        int window_end = 0;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+        for (size_t k = 1; k < partitions.size(); ++k) {
+            workers.emplace_back([&, k] {
+                uint64_t seen = 0;
+                while (true) {
+                    int end;
+                    {
+                        std::unique_lock<std::mutex> lock(mu);
+                        start_cv.wait(lock, [&] { return stopping || generation != seen; });
+                        if (stopping) return;
+                        seen = generation;
+                        end = window_end;
+                    }
+                    partitions[k].run_until(end);
+                    std::lock_guard<std::mutex> lock(mu);
+                    if (--pending == 0) done_cv.notify_one();
+                }
+            });
+        }
+
+        // Logged runs cap a window's span so the buffers stay around window_events
+        bool logging = Sink::enabled && opt.events;
+        int64_t span = logging ? 1 : INT_MAX;
+        for (int t; (t = next_event()) != INT_MAX;) {
+            int64_t h = horizon();
+            if (h <= t) {
+                step(t);
+                continue;
+            }
+            int end = (int)std::min({h, (int64_t)t + span, (int64_t)INT_MAX});
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                window_end = end;
+                pending = workers.size();
+                ++generation;
+            }
+            start_cv.notify_all();
+            partitions[0].run_until(end);
+            {
+                std::unique_lock<std::mutex> lock(mu);
+                done_cv.wait(lock, [&] { return pending == 0; });
+            }
+            if (logging) {
+                size_t most = 0;
+                for (const Partition& part : partitions) most = std::max(most, part.events.size());
+                if (most < window_events / 2) span = std::min(span * 2, (int64_t)INT_MAX);
+                else if (most > window_events * 2) span = std::max(span / 2, (int64_t)1);
+            }
+            merge_events();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            stopping = true;
+        }
+        start_cv.notify_all();
+        for (auto& w : workers) w.join();
+    }
 };
 
 // -- Worker thread --
 #include <pthread.h>
 
-struct ThreadArgs { Simulation* sim; };
+// Records per block handed to a FormatPool worker
+static const size_t FORMAT_BLOCK_SIZE = 4096;
+
+// Formats for AsyncSink, run on the main thread: the log functions, which write
+// today's text unless an embedder registered a sink with log_set_sink. Runs of
+// consecutive events of one kind go out through the batch calls.
+struct TextFormat {
+    static const size_t BATCH = 256;
+    log_execution_event executions[BATCH];
+    log_completion_event completions[BATCH];
+    size_t pending_executions{0};
+    size_t pending_completions{0};
+
+    // Deliver what is held back, keeping the order of the calls
+    void send() {
+        if (pending_executions) log_cpuburst_execution_batch(executions, pending_executions);
+        if (pending_completions) log_process_completion_batch(completions, pending_completions);
+        pending_executions = pending_completions = 0;
+    }
+
+    void echo(const BurstSpan& input) {
+        send();
+        echo_bursts(input);
+    }
+    void execution(uint32_t pid, int cpu, int io, int elapsed, ExecutionStopReasonType reason, int core) {
+        if (core != NO_CORE) {
+            send();
+            log_cpuburst_execution_core((unsigned)core, pid, (unsigned)cpu, (unsigned)io, (unsigned)elapsed, reason);
+            return;
+        }
+        if (pending_completions || pending_executions == BATCH) send();
+        executions[pending_executions++] = log_execution_event{pid, (unsigned)cpu, (unsigned)io, (unsigned)elapsed, reason};
+    }
+    void completion(uint32_t pid, int turnaround, int wait) {
+        if (pending_executions || pending_completions == BATCH) send();
+        completions[pending_completions++] = log_completion_event{pid, (unsigned)turnaround, (unsigned)wait};
+    }
+    void finish() {
+        send();
+        log_flush();
+    }
+};
+
+// or the same text formatted in blocks on a pool of threads (-f)
+struct PooledTextFormat {
+    FormatPool* pool;
 
+    void echo(const BurstSpan& input) {
+        pool -> sync();
+        echo_bursts(input);
+    }
+    void execution(uint32_t pid, int cpu, int io, int elapsed, ExecutionStopReasonType reason, int core) {
+        pool -> add(LogRecord::execution(pid, cpu, io, elapsed, reason, core));
+    }
+    void completion(uint32_t pid, int turnaround, int wait) { pool -> add(LogRecord::completion(pid, turnaround, wait)); }
+    void finish() {
+        pool -> sync();
+        log_flush();
+    }
+};
+
+// or the binary event trace (-t)
+struct TraceFormat {
+    TraceWriter* trace;
+
+    void echo(const BurstSpan& input) {
+        for (size_t i = 0; i < input.size(); ++i) trace -> bursts(input.line(i), input.line_size(i));
+    }
+    void execution(uint32_t pid, int cpu, int io, int elapsed, ExecutionStopReasonType reason, int core) {
+        trace -> execution(pid, cpu, io, elapsed, reason, core);
+    }
+    void completion(uint32_t pid, int turnaround, int wait) { trace -> completion(pid, turnaround, wait); }
+    // The sink finishes on the thread that drains it; whoever started the run asks
+    // the writer again whether it all got out (close() just answers once closed)
+    void finish() { trace -> close(); }
+};
+
+template <typename Sim>
+struct ThreadArgs { Sim* sim; };
+
+template <typename Sim>
 static void* scheduler_thread(void* vp) {
-    ThreadArgs* args = reinterpret_cast<ThreadArgs*>(vp);
+    ThreadArgs<Sim>* args = reinterpret_cast<ThreadArgs<Sim>*>(vp);
     args -> sim -> run();
     args -> sim -> print_stats_and_finish();
-    args -> sim -> shared -> done.store(true);
+    args -> sim -> shared -> set_done();
     return nullptr;
 }
 
+// Runs an initialized simulation on the worker thread while this one drains the sink
+template <typename Sim, typename Sink>
+static int run_on_thread(Sim& sim, Shared& shared, Sink& sink) {
+    pthread_t th;
+    ThreadArgs<Sim> ta{ &sim };
+    int rc = pthread_create(&th, NULL, scheduler_thread<Sim>, &ta);
+    if (rc != 0) {
+        std::perror("pthread_create");
+        return 1;
+    }
+
+    // Busy wait (explicitly required by the spec). No pthread_join.
+    // Rather than sleeping, the wait loop writes the output as the scheduler produces it;
+    // the sink is finished before done is set, so it ends as soon as the last record is written.
+    // With nothing to write it blocks instead of spinning: on the sink until the scheduler
+    // pushes more, or, once the sink has nothing left to give (always, for the sinks the
+    // scheduler thread writes itself), until done is set
+    while (!shared.done.load() || !sink.drained()) {
+        if (sink.drain() != 0) continue;
+        if (!sink.drained()) sink.wait_for_events();
+        else shared.wait_done(std::chrono::milliseconds(1));
+    }
+    return 0;
+}
+
+// Runs the simulation on the worker thread, fed either by a parsed arena or by a stream
+// (single CPU only; main parses the whole file for a multi-core run)
+template <typename Sink, typename BlockedQueue>
+static int run_simulation(const Options& opt, const BurstSpan* lines, BurstStream* stream, Sink& sink) {
+    Shared shared;
+    if (opt.cores > 1) {
+        MultiCoreSimulation<Sink, BlockedQueue> sim(opt, &shared, sink);
+        sim.init_from_lines(*lines);
+        return run_on_thread(sim, shared, sink);
+    }
+    Simulation<Sink, BlockedQueue> sim(opt, &shared, sink);
+    if (stream) sim.init_from_stream(*stream);
+    else sim.init_from_lines(*lines);
+    return run_on_thread(sim, shared, sink);
+}
+
+template <typename Sink>
+static int run_simulation(const Options& opt, const BurstSpan* lines, BurstStream* stream, Sink& sink) {
+    return (opt.engine == Engine::WHEEL) ? run_simulation<Sink, TimingWheelBlockedQueue>(opt, lines, stream, sink)
+                                         : run_simulation<Sink, HeapBlockedQueue>(opt, lines, stream, sink);
+}
+
+static int run_simulation(const Options& opt, const BurstSpan* lines, BurstStream* stream) {
+    switch (opt.sink) {
+        case Output::TRACE: {
+            TraceWriter trace;
+            if (!trace.open(opt.trace)) {
+                std::cout << "Unable to write <" << opt.trace << ">\n";
+                exit_ok();
+            }
+            AsyncSink<TraceFormat> sink(TraceFormat{ &trace });
+            int rc = run_simulation(opt, lines, stream, sink);
+            if (rc == 0 && !trace.close()) {
+                std::cout << "Unable to write <" << opt.trace << ">\n";
+                return 1;
+            }
+            return rc;
+        }
+        case Output::CHROME: {
+            ChromeTraceWriter trace;
+            if (!trace.open(opt.timeline, opt.cores)) {
+                std::cout << "Unable to write <" << opt.timeline << ">\n";
+                exit_ok();
+            }
+            ChromeTraceSink sink{ &trace };
+            int rc = run_simulation(opt, lines, stream, sink);
+            if (rc == 0 && !trace.close()) {
+                std::cout << "Unable to write <" << opt.timeline << ">\n";
+                return 1;
+            }
+            return rc;
+        }
+        case Output::COUNT: {
+            CountingSink sink;
+            return run_simulation(opt, lines, stream, sink);
+        }
+        case Output::NONE: {
+            NullSink sink;
+            return run_simulation(opt, lines, stream, sink);
+        }
+        default: {
+            // A sink registered through log_set_sink takes the events, not text
+            if (opt.format_threads > 1 && !log_get_sink()) {
+                FormatPool pool(opt.format_threads, FORMAT_BLOCK_SIZE);
+                AsyncSink<PooledTextFormat> sink(PooledTextFormat{ &pool });
+                return run_simulation(opt, lines, stream, sink);
+            }
+            AsyncSink<TextFormat> sink(TextFormat{});
+            return run_simulation(opt, lines, stream, sink);
+        }
+    }
+}
+
+// -- Parameter sweep --
+struct SweepConfig {
+    Strategy strategy;
+    int quantum;
+};
+
+static const char* strategy_name(Strategy s) {
+    switch (s) {
+        case Strategy::FCFS: return "fcfs";
+        case Strategy::RR: return "rr";
+        case Strategy::SJF: return "sjf";
+        case Strategy::SRTF: return "srtf";
+    }
+    return "";
+}
+
+// Mean and nearest-rank percentiles of one measure over all processes
+struct Distribution {
+    double mean{0};
+    int p50{0}, p90{0}, p99{0};
+};
+
+// What a sweep or batch run reports for one simulation
+struct RunSummary {
+    size_t processes{0};
+    Distribution turnaround;
+    Distribution wait;
+    int makespan{0};
+};
+
+static Distribution distribution(std::vector<int> v) {
+    Distribution d;
+    if (v.empty()) return d;
+    std::sort(v.begin(), v.end());
+    d.mean = (double)std::accumulate(v.begin(), v.end(), (long long)0) / (double)v.size();
+    auto rank = [&v](int p) { return v[(v.size() * p + 99) / 100 - 1]; };
+    d.p50 = rank(50); d.p90 = rank(90); d.p99 = rank(99);
+    return d;
+}
+
+// "1..4,8" -> 1 2 3 4 8
+static std::vector<int> parse_quanta(const std::string& list) {
+    std::vector<int> out;
+    std::stringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        size_t dots = item.find("..");
+        std::string lo = item.substr(0, dots), hi = (dots == std::string::npos) ? lo : item.substr(dots + 2);
+        char *end1 = nullptr, *end2 = nullptr;
+        long a = std::strtol(lo.c_str(), &end1, 10), b = std::strtol(hi.c_str(), &end2, 10);
+        if (*end1 || *end2 || lo.empty() || hi.empty() || a <= 0 || b < a) {
+            std::cout << "Time quantum must be a number and bigger than 0\n";
+            exit_ok();
+        }
+        for (long q = a; q <= b; ++q) out.push_back((int)q);
+    }
+    return out;
+}
+
+// "fcfs,rr" -> FCFS once, then RR with every quantum; FCFS ignores the quantum
+static std::vector<SweepConfig> sweep_configs(const Options& opt) {
+    std::vector<int> quanta = parse_quanta(opt.quanta);
+    std::vector<SweepConfig> out;
+    bool fcfs = false, rr = false, sjf = false, srtf = false;
+    std::stringstream in(opt.strategies);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        // Unknown strategies fall back to FCFS, as they do for a single run
+        if (item == "rr") rr = true;
+        else if (item == "sjf") sjf = true;
+        else if (item == "srtf") srtf = true;
+        else fcfs = true;
+    }
+    if (fcfs) out.push_back(SweepConfig{Strategy::FCFS, 0});
+    if (sjf) out.push_back(SweepConfig{Strategy::SJF, 0});
+    if (srtf) out.push_back(SweepConfig{Strategy::SRTF, 0});
+    if (rr) {
+        for (int q : quanta) out.push_back(SweepConfig{Strategy::RR, q});
+    }
+    return out;
+}
+
+// One simulation, run straight on the calling thread (no scheduler thread)
+template <typename Sim>
+static RunSummary summarize(const Options& opt, const BurstSpan& lines) {
+    // Sweeps and batches already keep every host thread busy with a run of its own
+    Options run = opt;
+    run.sim_threads = 1;
+    Shared shared; SummarySink sink;
+    Sim sim(run, &shared, sink);
+    sim.init_from_lines(lines);
+    sim.run();
+    sim.print_stats_and_finish();
+
+    RunSummary r;
+    r.processes = lines.size();
+    r.makespan = sink.turnaround.empty() ? 0 : *std::max_element(sink.turnaround.begin(), sink.turnaround.end());
+    r.turnaround = distribution(std::move(sink.turnaround));
+    r.wait = distribution(std::move(sink.wait));
+    return r;
+}
+
+template <typename BlockedQueue>
+static RunSummary summarize_run(const Options& opt, const BurstSpan& lines) {
+    return (opt.cores > 1) ? summarize<MultiCoreSimulation<SummarySink, BlockedQueue>>(opt, lines)
+                           : summarize<Simulation<SummarySink, BlockedQueue>>(opt, lines);
+}
+
+static RunSummary summarize_run(const Options& opt, const BurstSpan& lines) {
+    return (opt.engine == Engine::WHEEL) ? summarize_run<TimingWheelBlockedQueue>(opt, lines)
+                                         : summarize_run<HeapBlockedQueue>(opt, lines);
+}
+
+// The columns every summary table ends with
+static void print_summary_header() {
+    std::printf(" | %10s %8s %8s %8s | %10s %8s %8s %8s | %10s\n",
+                "turnaround", "p50", "p90", "p99", "wait", "p50", "p90", "p99", "makespan");
+}
+
+static void print_summary(const RunSummary& r) {
+    std::printf(" | %10.2f %8d %8d %8d | %10.2f %8d %8d %8d | %10d\n",
+                r.turnaround.mean, r.turnaround.p50, r.turnaround.p90, r.turnaround.p99,
+                r.wait.mean, r.wait.p50, r.wait.p90, r.wait.p99, r.makespan);
+}
+
+// Run every configuration on a pool of one thread per core, reading the input
+// parsed once, then print a table in configuration order
+static int run_sweep(const Options& opt, const BurstSpan& lines) {
+    std::vector<SweepConfig> configs = sweep_configs(opt);
+    std::vector<RunSummary> results(configs.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1)) < configs.size();) {
+            Options run = opt;
+            run.strategy = configs[i].strategy;
+            if (configs[i].quantum) run.quantum = configs[i].quantum;
+            results[i] = summarize_run(run, lines);
+        }
+    };
+    size_t threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), configs.size());
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t) pool.emplace_back(worker);
+    for (auto& t : pool) t.join();
+
+    std::printf("%-8s %7s", "strategy", "quantum");
+    print_summary_header();
+    for (size_t i = 0; i < configs.size(); ++i) {
+        bool rr = configs[i].strategy == Strategy::RR;
+        std::printf("%-8s %7s", strategy_name(configs[i].strategy), rr ? std::to_string(configs[i].quantum).c_str() : "-");
+        print_summary(results[i]);
+    }
+    return 0;
+}
+
+// -- Batch runs --
+// Operands in order, a directory standing for its regular files sorted by name
+// (hidden files skipped)
+static std::vector<std::string> expand_inputs(const std::vector<std::string>& operands) {
+    std::vector<std::string> out;
+    for (const std::string& path : operands) {
+        DIR* d = opendir(path.c_str());
+        if (!d) {
+            out.push_back(path);
+            continue;
+        }
+        std::vector<std::string> names;
+        while (struct dirent* e = readdir(d)) {
+            if (e -> d_name[0] == '.') continue;
+            std::string full = path + "/" + e -> d_name;
+            if (!is_directory(full)) names.push_back(full);
+        }
+        closedir(d);
+        std::sort(names.begin(), names.end());
+        out.insert(out.end(), names.begin(), names.end());
+    }
+    return out;
+}
+
+struct BatchResult {
+    std::string error; // why the file was not simulated, empty if it was
+    RunSummary summary;
+};
+
+// Simulate every file independently on a work-stealing pool with one long-lived
+// thread per core, then print one summary line per file in input order. A file
+// that cannot be read gets its error on its line instead of stopping the batch.
+static int run_batch(const Options& opt) {
+    std::vector<std::string> inputs = expand_inputs(opt.files);
+    std::vector<BatchResult> results(inputs.size());
+    run_work_stealing(inputs.size(), std::max(1u, std::thread::hardware_concurrency()), [&](size_t i) {
+        // The pool already has a thread per core, so each file is parsed on its own
+        BurstFile file;
+        BurstError err = file.open(inputs[i], 1);
+        if (err != BurstError::NONE) results[i].error = burst_error_message(err, inputs[i]);
+        else results[i].summary = summarize_run(opt, file.span());
+    });
+
+    int width = 4;
+    for (const std::string& path : inputs) width = std::max(width, (int)path.size());
+    std::printf("%-*s %9s", width, "file", "processes");
+    print_summary_header();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!results[i].error.empty()) {
+            std::printf("%-*s %s\n", width, inputs[i].c_str(), results[i].error.c_str());
+            continue;
+        }
+        std::printf("%-*s %9zu", width, inputs[i].c_str(), results[i].summary.processes);
+        print_summary(results[i].summary);
+    }
+    return 0;
+}
+
 int main(int argc, char** argv) {
     Options opt = parse_args(argc, argv);
-    auto lines = read_bursts(opt.file);
 
-    // Echo input
-    for (size_t i = 0; i < lines.size(); ++ i) {
-        log_process_bursts((unsigned int*)lines[i].bursts.data(), lines[i].bursts.size());
+    if (opt.convert) {
+        BurstFile in;
+        read_bursts(opt.file, in);
+        if (!save_bursts_binary(opt.output, in.span())) {
+            std::cout << "Unable to write <" << opt.output << ">\n";
+        }
+        return 0;
     }
 
-    Shared shared; Simulation sim(opt, &shared);
-    sim.init_from_lines(lines);
+    if (opt.files.size() > 1 || is_directory(opt.file)) return run_batch(opt);
 
-    pthread_t th;
-    ThreadArgs ta{ &sim };
-    int rc = pthread_create(&th, NULL, scheduler_thread, &ta);
-    if (rc != 0) {
-        std::perror("pthread_create");
-        return 1;
+    if (opt.sweep) {
+        BurstFile file;
+        read_bursts(opt.file, file);
+        return run_sweep(opt, file.span());
     }
 
-    // Busy wait (explicitly required by the spec). No pthread_join
-    while (!shared.done.load()) {
-        // Small sleep to avoid burning CPU in real environment
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    // Binary traces need no parsing, so there is nothing to pipeline; multi-core
+    // runs deal out every process at the start, and SJF and SRTF pick the shortest
+    // of them, so they need the whole file
+    bool shortest_first = opt.strategy == Strategy::SJF || opt.strategy == Strategy::SRTF;
+    if (opt.pipeline && opt.cores == 1 && !shortest_first && !is_binary_burst_file(opt.file)) {
+        // Parser thread -> bounded chunk queue -> scheduler thread
+        BurstStream stream(opt.file);
+        if (stream.error() == BurstError::OPEN_FAILED) report_burst_error(BurstError::OPEN_FAILED, opt.file);
+        return run_simulation(opt, nullptr, &stream);
     }
 
+    BurstFile file;
+    read_bursts(opt.file, file);
+    BurstSpan lines = file.span();
+
+    // The input is echoed by the output side, ahead of the first event
+    int rc = run_simulation(opt, &lines, nullptr);
+
     // Main exits
-    return 0;
+    return rc;
 }
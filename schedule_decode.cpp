@@ -0,0 +1,115 @@
+// File: schedule_decode.cpp
+// Build: make (produces ./schedule-decode)
+// Run examples:
+// ./schedule -t run.trc bursts.txt    # binary event trace instead of text
+// ./schedule-decode run.trc           # the text ./schedule bursts.txt would print
+// ./schedule-decode --from 1000000000 --to 1000001000 run.trc
+//                                     # only the execution lines in that time window
+//
+// Turns a binary event trace (trace.h) back into the scheduler's text output,
+// through the same log functions, so the bytes match exactly. A time window is
+// found through the trace's sparse index, so only the records around it are read.
+
+#include <cstdint>
+#include <cstdlib>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include "log.h"
+#include "trace.h"
+
+static void usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [--from T] [--to T] <trace-file>\n";
+    std::exit(1);
+}
+
+static uint32_t parse_time(const char* prog, const char* arg) {
+    char* end = nullptr;
+    unsigned long long v = std::strtoull(arg, &end, 10);
+    if (end == arg || *end != '\0' || v > UINT32_MAX) usage(prog);
+    return (uint32_t)v;
+}
+
+static void log_execution(const TraceEvent& e) {
+    if (e.core == NO_CORE) log_cpuburst_execution(e.pid, e.cpu, e.io, e.elapsed, e.reason);
+    else log_cpuburst_execution_core((unsigned)e.core, e.pid, e.cpu, e.io, e.elapsed, e.reason);
+}
+
+// Execution lines with from <= time elapsed <= to, in trace order
+static void decode_window(TraceReader& reader, uint32_t from, uint32_t to) {
+    reader.seek(from);
+    TraceEvent e;
+    while (reader.next(e)) {
+        if (e.kind != TraceEvent::EXECUTION) {
+            // The completions follow the last execution record
+            if (e.kind == TraceEvent::COMPLETION) break;
+            continue;
+        }
+        if (e.elapsed > to) break;
+        if (e.elapsed >= from) log_execution(e);
+    }
+}
+
+int main(int argc, char** argv) {
+    static const struct option long_opts[] = {
+        {"from", required_argument, nullptr, 'f'},
+        {"to", required_argument, nullptr, 't'},
+        {nullptr, 0, nullptr, 0},
+    };
+    bool window = false;
+    uint32_t from = 0, to = UINT32_MAX;
+    int c;
+    while ((c = getopt_long(argc, argv, "", long_opts, nullptr)) != -1) {
+        switch (c) {
+            case 'f':
+                from = parse_time(argv[0], optarg);
+                window = true;
+                break;
+            case 't':
+                to = parse_time(argv[0], optarg);
+                window = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (optind + 1 != argc) usage(argv[0]);
+
+    std::string path = argv[optind];
+    TraceReader reader;
+    if (!reader.open(path)) {
+        std::cout << "Invalid event trace <" << path << ">\n";
+        return 1;
+    }
+
+    if (window) {
+        decode_window(reader, from, to);
+        log_flush();
+        if (reader.error()) {
+            std::cout << "Invalid event trace <" << path << ">\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    TraceEvent e;
+    while (reader.next(e)) {
+        switch (e.kind) {
+            case TraceEvent::EXECUTION:
+                log_execution(e);
+                break;
+            case TraceEvent::COMPLETION:
+                log_process_completion(e.pid, e.turnaround, e.wait);
+                break;
+            case TraceEvent::BURSTS:
+                log_process_bursts(e.bursts.data(), e.bursts.size());
+                break;
+        }
+    }
+    log_flush();
+    if (reader.error()) {
+        std::cout << "Invalid event trace <" << path << ">\n";
+        return 1;
+    }
+    return 0;
+}
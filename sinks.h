@@ -0,0 +1,204 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Where Simulation sends its log events. Simulation is instantiated once per sink
+// type, so every call below is resolved at compile time: a sink that ignores an
+// event costs nothing, with no indirect call left behind.
+//
+// A sink has two halves. The event calls are made on the scheduler thread:
+//   echo(input)                          the input is complete and valid, echo it
+//   execution(pid, cpu, io, elapsed, reason, core)
+//                                        core is NO_CORE unless the run has several
+//   completion(pid, turnaround, wait)
+//   finish()                             no more events
+// and main's wait loop calls drain() to do any pending output until drained(), and
+// wait_for_events() to sleep while there is none yet. A sink that only writes from
+// the scheduler thread is always drained.
+// enabled is false for a sink that wants no execution events at all, so the
+// scheduler does not even sample them.
+//
+// A sink with timeline set also gets the scheduler's state over time:
+//   segment(core, pid, start, end)       a CPU segment ran (core 0 on a single CPU)
+//   blocked(pid, start, wake)            a process entered I/O
+//   queues(time, ready, blocked)         queue lengths after a dispatch
+// The scheduler tests timeline before working out the arguments.
+
+#ifndef SINKS_H
+#define SINKS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "bursts.h"
+#include "events.h"
+#include "log.h"
+#include "trace.h"
+
+// Capacity of the scheduler -> main thread ring, in records
+static const size_t EVENT_RING_SIZE = 1 << 14;
+
+// Discards everything; measures the scheduler alone
+struct NullSink {
+    static const bool enabled = false;
+    static const bool timeline = false;
+
+    void echo(const BurstSpan*) {}
+    void execution(uint32_t, int, int, int, ExecutionStopReasonType, int) {}
+    void completion(uint32_t, int, int) {}
+    void finish() {}
+    void segment(int, uint32_t, int, int) {}
+    void blocked(uint32_t, int, int) {}
+    void queues(int, size_t, size_t) {}
+
+    size_t drain() { return 0; }
+    bool drained() const { return true; }
+    void wait_for_events() {}
+};
+
+// Counts the events and prints the totals at the end instead of the events
+struct CountingSink {
+    static const bool enabled = true;
+    static const bool timeline = false;
+
+    uint64_t executions[3] = {0, 0, 0}; // by ExecutionStopReasonType
+    uint64_t completions{0};
+
+    void echo(const BurstSpan*) {}
+    void execution(uint32_t, int, int, int, ExecutionStopReasonType reason, int) { ++executions[reason]; }
+    void completion(uint32_t, int, int) { ++completions; }
+    void finish() {
+        uint64_t total = executions[ENTER_IO] + executions[QUANTUM_EXPIRED] + executions[COMPLETED];
+        std::printf("execution events = %llu (enter io = %llu, quantum expired = %llu, completed = %llu), "
+                    "completions = %llu\n",
+                    (unsigned long long)total, (unsigned long long)executions[ENTER_IO],
+                    (unsigned long long)executions[QUANTUM_EXPIRED], (unsigned long long)executions[COMPLETED],
+                    (unsigned long long)completions);
+        std::fflush(stdout);
+    }
+    void segment(int, uint32_t, int, int) {}
+    void blocked(uint32_t, int, int) {}
+    void queues(int, size_t, size_t) {}
+
+    size_t drain() { return 0; }
+    bool drained() const { return true; }
+    void wait_for_events() {}
+};
+
+// Keeps the per-process results and nothing else, for --sweep
+struct SummarySink {
+    static const bool enabled = false;
+    static const bool timeline = false;
+
+    std::vector<int> turnaround; // in completion order
+    std::vector<int> wait;
+
+    void echo(const BurstSpan*) {}
+    void execution(uint32_t, int, int, int, ExecutionStopReasonType, int) {}
+    void completion(uint32_t, int t, int w) {
+        turnaround.push_back(t);
+        wait.push_back(w);
+    }
+    void finish() {}
+    void segment(int, uint32_t, int, int) {}
+    void blocked(uint32_t, int, int) {}
+    void queues(int, size_t, size_t) {}
+
+    size_t drain() { return 0; }
+    bool drained() const { return true; }
+    void wait_for_events() {}
+};
+
+// Hands fixed-size records to the main thread through a lock-free ring, so the
+// scheduler never blocks on output; main formats them with Format as it drains.
+// Format has the same event calls, taking the input span for echo, and its
+// finish() flushes.
+template <typename Format>
+class AsyncSink {
+public:
+    static const bool enabled = true;
+    static const bool timeline = false;
+
+    explicit AsyncSink(const Format& f): format(f), events(EVENT_RING_SIZE) {}
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    // The input must stay put until the echo has been drained
+    void echo(const BurstSpan* in) {
+        input = in;
+        events.push(LogRecord::marker(LogRecord::ECHO));
+    }
+    void execution(uint32_t pid, int cpu, int io, int elapsed, ExecutionStopReasonType reason, int core) {
+        events.push(LogRecord::execution(pid, cpu, io, elapsed, reason, core));
+    }
+    void completion(uint32_t pid, int turnaround, int wait) {
+        events.push(LogRecord::completion(pid, turnaround, wait));
+    }
+    void finish() {
+        events.push(LogRecord::marker(LogRecord::END));
+        events.flush();
+    }
+    void segment(int, uint32_t, int, int) {}
+    void blocked(uint32_t, int, int) {}
+    void queues(int, size_t, size_t) {}
+
+    // Write whatever the scheduler has produced so far, returns how many records
+    size_t drain() {
+        LogRecord batch[256];
+        size_t n = events.pop(batch, 256);
+        for (size_t i = 0; i < n; ++i) write(batch[i]);
+        return n;
+    }
+    // END has been written
+    bool drained() const { return finished; }
+    // Nothing to drain: sleep until the scheduler pushes more
+    void wait_for_events() { events.wait(std::chrono::milliseconds(1)); }
+
+private:
+    void write(const LogRecord& r) {
+        switch (r.kind) {
+            case LogRecord::EXECUTION:
+                format.execution(r.pid, r.cpu, r.io, r.elapsed, (ExecutionStopReasonType)r.reason, r.core);
+                break;
+            case LogRecord::COMPLETION:
+                format.completion(r.pid, r.elapsed, r.cpu);
+                break;
+            case LogRecord::ECHO:
+                format.echo(*input);
+                break;
+            case LogRecord::END:
+                format.finish();
+                finished = true;
+                break;
+        }
+    }
+
+    Format format;
+    SpscRing<LogRecord> events;
+    const BurstSpan* input{nullptr}; // published to main by the ECHO push
+    bool finished{false};
+};
+
+// Timeline of the run as a Chrome trace (-j), written straight from the scheduler
+// thread through the writer's fixed buffer. Takes no log events of its own.
+struct ChromeTraceSink {
+    static const bool enabled = false;
+    static const bool timeline = true;
+
+    ChromeTraceWriter* trace;
+
+    void echo(const BurstSpan*) {}
+    void execution(uint32_t, int, int, int, ExecutionStopReasonType, int) {}
+    void completion(uint32_t, int, int) {}
+    // The run checks the writer's close() again for a write that failed
+    void finish() { trace -> close(); }
+    void segment(int core, uint32_t pid, int start, int end) { trace -> cpu_slice(core, pid, start, end); }
+    void blocked(uint32_t pid, int start, int wake) { trace -> io_slice(pid, start, wake); }
+    void queues(int time, size_t ready, size_t blocked) { trace -> queues(time, ready, blocked); }
+
+    size_t drain() { return 0; }
+    bool drained() const { return true; }
+    void wait_for_events() {}
+};
+
+#endif
@@ -0,0 +1,354 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+
+#include "trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char kTraceMagic[8] = {'S', 'C', 'H', 'T', 'R', 'C', 'E', '1'};
+static const char kIndexMagic[8] = {'S', 'C', 'H', 'T', 'I', 'D', 'X', '1'};
+
+struct TraceFooter {
+    uint64_t index_offset;
+    uint64_t count;
+    char magic[8];
+};
+static_assert(sizeof(TraceIndexEntry) == 16, "index entries are written as raw bytes");
+static_assert(sizeof(TraceFooter) == 24, "trace footer must be packed");
+
+static const uint8_t kTagCompletion = 3;
+static const uint8_t kTagBursts = 4;
+// Tag of an execution on a core is this plus the reason
+static const uint8_t kTagCoreExecution = 5;
+
+static const size_t kTraceBufferSize = 1 << 18;
+// Longest varint of a 32-bit value
+static const size_t kMaxVarint = 5;
+
+TraceWriter::TraceWriter() = default;
+
+TraceWriter::~TraceWriter() { close(); }
+
+bool TraceWriter::open(const std::string& path) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    buffer.resize(kTraceBufferSize);
+    std::memcpy(buffer.data(), kTraceMagic, sizeof kTraceMagic);
+    used = sizeof kTraceMagic;
+    return true;
+}
+
+void TraceWriter::flush() {
+    size_t done = 0;
+    while (done < used && !failed) {
+        ssize_t n = write(fd, buffer.data() + done, used - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        done += (size_t)n;
+    }
+    written += used;
+    used = 0;
+}
+
+void TraceWriter::reserve(size_t bytes) {
+    if (used + bytes > buffer.size()) flush();
+}
+
+void TraceWriter::put_varint(uint32_t v) {
+    while (v >= 0x80) {
+        buffer[used++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    buffer[used++] = (unsigned char)v;
+}
+
+void TraceWriter::bursts(const int* bursts, size_t count) {
+    reserve(1 + kMaxVarint);
+    buffer[used++] = kTagBursts;
+    put_varint((uint32_t)count);
+    for (size_t i = 0; i < count; ++i) {
+        reserve(kMaxVarint);
+        put_varint((uint32_t)bursts[i]);
+    }
+}
+
+void TraceWriter::execution(uint32_t pid, int cpu, int io, int elapsed, ExecutionStopReasonType reason, int core) {
+    reserve(1 + 5 * kMaxVarint);
+    if (executions++ % kTraceIndexInterval == 0) {
+        index.push_back(TraceIndexEntry{written + used, (uint32_t)elapsed, (uint32_t)last_elapsed});
+    }
+    buffer[used++] = (unsigned char)(core == NO_CORE ? reason : kTagCoreExecution + reason);
+    // The clock never goes back, so the delta is small and never negative
+    put_varint((uint32_t)(elapsed - last_elapsed));
+    put_varint(pid);
+    put_varint((uint32_t)cpu);
+    put_varint((uint32_t)io);
+    if (core != NO_CORE) put_varint((uint32_t)core);
+    last_elapsed = elapsed;
+}
+
+void TraceWriter::completion(uint32_t pid, int turnaround, int wait) {
+    reserve(1 + 3 * kMaxVarint);
+    buffer[used++] = kTagCompletion;
+    put_varint(pid);
+    put_varint((uint32_t)turnaround);
+    put_varint((uint32_t)wait);
+}
+
+// Copy raw bytes through the buffer
+void TraceWriter::put_bytes(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    while (size > 0) {
+        reserve(1);
+        size_t n = std::min(size, buffer.size() - used);
+        std::memcpy(buffer.data() + used, p, n);
+        used += n;
+        p += n;
+        size -= n;
+    }
+}
+
+bool TraceWriter::close() {
+    if (fd < 0) return !failed;
+    TraceFooter footer;
+    footer.index_offset = written + used;
+    footer.count = index.size();
+    std::memcpy(footer.magic, kIndexMagic, sizeof footer.magic);
+    put_bytes(index.data(), index.size() * sizeof(TraceIndexEntry));
+    put_bytes(&footer, sizeof footer);
+    std::vector<TraceIndexEntry>().swap(index);
+    flush();
+    if (::close(fd) != 0) failed = true;
+    fd = -1;
+    return !failed;
+}
+
+bool TraceReader::open(const std::string& path) {
+    if (!view.open(path)) return false;
+    if (view.size() < sizeof kTraceMagic || std::memcmp(view.data(), kTraceMagic, sizeof kTraceMagic) != 0) return false;
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(view.data());
+    begin = pos = data + sizeof kTraceMagic;
+    end = data + view.size();
+
+    // The index is optional; one that does not fit the file is ignored
+    TraceFooter footer;
+    size_t size = view.size();
+    if (size < sizeof kTraceMagic + sizeof footer) return true;
+    std::memcpy(&footer, data + size - sizeof footer, sizeof footer);
+    if (std::memcmp(footer.magic, kIndexMagic, sizeof kIndexMagic) != 0) return true;
+    if (footer.index_offset < sizeof kTraceMagic || footer.index_offset > size - sizeof footer) return true;
+    if (footer.count != (size - sizeof footer - footer.index_offset) / sizeof(TraceIndexEntry)) return true;
+    end = data + footer.index_offset;
+    // Entries are copied out, the records before them can have any length
+    index.resize(footer.count);
+    std::memcpy(index.data(), end, footer.count * sizeof(TraceIndexEntry));
+    return true;
+}
+
+void TraceReader::seek(uint32_t t) {
+    // Last entry before t: records at exactly t may start before the first entry at t
+    auto it = std::lower_bound(index.begin(), index.end(), t,
+                               [](const TraceIndexEntry& e, uint32_t v) { return e.elapsed < v; });
+    bad = false;
+    if (it == index.begin()) {
+        pos = begin;
+        elapsed = 0;
+        return;
+    }
+    --it;
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(view.data());
+    if (it -> offset < (uint64_t)(begin - data) || it -> offset >= (uint64_t)(end - data)) {
+        bad = true;
+        return;
+    }
+    pos = data + it -> offset;
+    elapsed = it -> base;
+}
+
+bool TraceReader::get_varint(uint32_t& v) {
+    uint64_t x = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos == end) break;
+        unsigned char b = *pos++;
+        x |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            if (x > UINT32_MAX) break;
+            v = (uint32_t)x;
+            return true;
+        }
+    }
+    bad = true;
+    return false;
+}
+
+bool TraceReader::next(TraceEvent& e) {
+    if (bad || pos == end) return false;
+    uint8_t tag = *pos++;
+    bool on_core = tag >= kTagCoreExecution && tag <= kTagCoreExecution + COMPLETED;
+    if (tag <= COMPLETED || on_core) {
+        uint32_t delta, core = 0;
+        e.kind = TraceEvent::EXECUTION;
+        e.reason = (ExecutionStopReasonType)(on_core ? tag - kTagCoreExecution : tag);
+        if (!get_varint(delta) || !get_varint(e.pid) || !get_varint(e.cpu) || !get_varint(e.io)) return false;
+        if (on_core && !get_varint(core)) return false;
+        if (core > INT16_MAX) {
+            bad = true;
+            return false;
+        }
+        e.core = on_core ? (int)core : NO_CORE;
+        elapsed += delta;
+        e.elapsed = elapsed;
+        return true;
+    }
+    if (tag == kTagCompletion) {
+        e.kind = TraceEvent::COMPLETION;
+        return get_varint(e.pid) && get_varint(e.turnaround) && get_varint(e.wait);
+    }
+    if (tag == kTagBursts) {
+        uint32_t count;
+        e.kind = TraceEvent::BURSTS;
+        if (!get_varint(count)) return false;
+        // Every burst takes at least one byte
+        if (count > (size_t)(end - pos)) {
+            bad = true;
+            return false;
+        }
+        e.bursts.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!get_varint(e.bursts[i])) return false;
+        }
+        return true;
+    }
+    bad = true;
+    return false;
+}
+
+// -- Chrome trace --
+#define PUT_LITERAL(s) put(s, sizeof(s) - 1)
+
+// Longest single event, integers included
+static const size_t kMaxChromeEvent = 160;
+
+ChromeTraceWriter::ChromeTraceWriter() = default;
+
+ChromeTraceWriter::~ChromeTraceWriter() { close(); }
+
+bool ChromeTraceWriter::open(const std::string& path, unsigned cores) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    buffer.resize(kTraceBufferSize);
+    PUT_LITERAL("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    // Name the two processes the tracks are grouped under, and the CPU tracks
+    begin_event();
+    PUT_LITERAL("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}}");
+    if (cores <= 1) {
+        begin_event();
+        PUT_LITERAL("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CPU\"}}");
+        cores = 0;
+    }
+    for (unsigned c = 0; c < cores; ++c) {
+        begin_event();
+        PUT_LITERAL("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+        put_uint(c);
+        PUT_LITERAL(",\"args\":{\"name\":\"CPU ");
+        put_uint(c);
+        PUT_LITERAL("\"}}");
+    }
+    begin_event();
+    PUT_LITERAL("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"I/O\"}}");
+    return true;
+}
+
+void ChromeTraceWriter::flush() {
+    size_t done = 0;
+    while (done < used && !failed) {
+        ssize_t n = write(fd, buffer.data() + done, used - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        done += (size_t)n;
+    }
+    used = 0;
+}
+
+void ChromeTraceWriter::reserve(size_t bytes) {
+    if (used + bytes > buffer.size()) flush();
+}
+
+void ChromeTraceWriter::put(const char* s, size_t len) {
+    std::memcpy(buffer.data() + used, s, len);
+    used += len;
+}
+
+void ChromeTraceWriter::put_uint(uint64_t v) {
+    char tmp[20];
+    char* p = tmp + sizeof tmp;
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    put(p, (size_t)(tmp + sizeof tmp - p));
+}
+
+// Make room for one event and separate it from the previous one
+void ChromeTraceWriter::begin_event() {
+    reserve(kMaxChromeEvent);
+    if (!first) PUT_LITERAL(",\n");
+    first = false;
+}
+
+void ChromeTraceWriter::cpu_slice(int core, uint32_t pid, int start, int end) {
+    begin_event();
+    PUT_LITERAL("{\"name\":\"P");
+    put_uint(pid);
+    PUT_LITERAL("\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+    put_uint((uint64_t)core);
+    PUT_LITERAL(",\"ts\":");
+    put_time(start);
+    PUT_LITERAL(",\"dur\":");
+    put_time(end - start);
+    PUT_LITERAL("}");
+}
+
+void ChromeTraceWriter::io_slice(uint32_t pid, int start, int end) {
+    begin_event();
+    PUT_LITERAL("{\"name\":\"P");
+    put_uint(pid);
+    PUT_LITERAL("\",\"cat\":\"io\",\"ph\":\"X\",\"pid\":2,\"tid\":");
+    put_uint(pid);
+    PUT_LITERAL(",\"ts\":");
+    put_time(start);
+    PUT_LITERAL(",\"dur\":");
+    put_time(end - start);
+    PUT_LITERAL("}");
+}
+
+void ChromeTraceWriter::queues(int time, size_t ready, size_t blocked) {
+    begin_event();
+    PUT_LITERAL("{\"name\":\"queues\",\"ph\":\"C\",\"pid\":1,\"ts\":");
+    put_time(time);
+    PUT_LITERAL(",\"args\":{\"ready\":");
+    put_uint(ready);
+    PUT_LITERAL(",\"blocked\":");
+    put_uint(blocked);
+    PUT_LITERAL("}}");
+}
+
+bool ChromeTraceWriter::close() {
+    if (fd < 0) return !failed;
+    reserve(kMaxChromeEvent);
+    PUT_LITERAL("\n]}\n");
+    flush();
+    if (::close(fd) != 0) failed = true;
+    fd = -1;
+    return !failed;
+}
@@ -0,0 +1,168 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Binary event trace, written by `schedule -t <file>` in place of the text log and
+// turned back into the exact text by schedule-decode. Integers are unsigned LEB128
+// varints (7 bits per byte, low bits first):
+//   char magic[8]       "SCHTRCE1"
+//   records until the end of the file, each a tag byte and then its varints:
+//     tag 0..2  execution, tag is the ExecutionStopReasonType:
+//               elapsed - elapsed of the previous execution record, pid, cpu, io
+//     tag 3     completion: pid, turnaround, wait
+//     tag 4     input echo of one process: burst count, bursts...
+//     tag 5..7  execution on a core of a multi-core run, tag is 5 + the reason:
+//               the varints of tags 0..2, then the core
+// followed by a sparse time index over the execution records, one entry every
+// kTraceIndexInterval of them (native endian, like the binary burst files):
+//   TraceIndexEntry entries[count]
+//   uint64_t index_offset          file offset of entries[0], where the records end
+//   uint64_t count
+//   char     magic[8]              "SCHTIDX1"
+// A trace without the trailing index (a run that was cut short) still decodes
+// from the start; it just cannot seek.
+//
+// ChromeTraceWriter writes the other trace output, a timeline in the Chrome Trace
+// Event Format (`schedule -j <file>`) for chrome://tracing and Perfetto.
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bursts.h"
+#include "events.h"
+#include "log.h"
+
+// Execution records between two index entries
+static const uint64_t kTraceIndexInterval = 4096;
+
+// Where to resume decoding to reach the execution record at offset
+struct TraceIndexEntry {
+    uint64_t offset;  // file offset of the record's tag byte
+    uint32_t elapsed; // elapsed time of the record
+    uint32_t base;    // elapsed time its delta is relative to
+};
+
+// Buffered trace encoder, written out with write(2) when the buffer fills up
+class TraceWriter {
+public:
+    TraceWriter();
+    ~TraceWriter();
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Create path and write the header; false if it could not be created
+    bool open(const std::string& path);
+
+    void bursts(const int* bursts, size_t count);
+    // core is NO_CORE on a single CPU
+    void execution(uint32_t pid, int cpu, int io, int elapsed, ExecutionStopReasonType reason, int core);
+    void completion(uint32_t pid, int turnaround, int wait);
+
+    // Write the time index, flush and close; false if any write failed
+    bool close();
+
+private:
+    void reserve(size_t bytes);
+    void put_varint(uint32_t v);
+    void put_bytes(const void* data, size_t size);
+    void flush();
+
+    int fd{-1};
+    std::vector<unsigned char> buffer;
+    size_t used{0};
+    uint64_t written{0}; // bytes already flushed to the file
+    int last_elapsed{0};
+    uint64_t executions{0};
+    std::vector<TraceIndexEntry> index;
+    bool failed{false};
+};
+
+// One decoded record. Fields a kind does not use are left alone.
+struct TraceEvent {
+    enum Kind : uint8_t { EXECUTION, COMPLETION, BURSTS };
+
+    Kind kind;
+    ExecutionStopReasonType reason; // EXECUTION
+    uint32_t pid;                   // EXECUTION, COMPLETION
+    uint32_t cpu;                   // EXECUTION
+    uint32_t io;                    // EXECUTION
+    uint32_t elapsed;               // EXECUTION
+    int core;                       // EXECUTION, NO_CORE on a single CPU
+    uint32_t turnaround;            // COMPLETION
+    uint32_t wait;                  // COMPLETION
+    std::vector<unsigned int> bursts; // BURSTS
+};
+
+// Decodes a mapped trace one record at a time
+class TraceReader {
+public:
+    // false if path could not be opened or is not a trace
+    bool open(const std::string& path);
+
+    // Decode the next record into e; false at the end of the trace, or at a record
+    // that is cut short or malformed, in which case error() is true
+    bool next(TraceEvent& e);
+    bool error() const { return bad; }
+
+    // Jump close to the first execution record at or after time t using the index.
+    // The records before it in the trace are skipped unread; execution records
+    // earlier than t may still follow, up to kTraceIndexInterval of them. Without an
+    // index this rewinds to the first record.
+    void seek(uint32_t t);
+
+private:
+    bool get_varint(uint32_t& v);
+
+    FileView view;
+    const unsigned char* begin{nullptr}; // first record
+    const unsigned char* pos{nullptr};
+    const unsigned char* end{nullptr};
+    uint32_t elapsed{0};
+    bool bad{false};
+    std::vector<TraceIndexEntry> index;
+};
+
+// Streams a Chrome Trace Event Format JSON file through a fixed buffer, so memory
+// stays bounded however long the run. Simulated milliseconds are written as trace
+// milliseconds (ts and dur are in microseconds, hence the * 1000). Tracks:
+//   "CPU"          one slice per CPU segment, named after the process, on a
+//                  track per core (tid = core)
+//   "I/O"          one slice per I/O burst, on a track per process (tid = pid)
+//   "queues"       counter with the ready and blocked queue lengths
+class ChromeTraceWriter {
+public:
+    ChromeTraceWriter();
+    ~ChromeTraceWriter();
+    ChromeTraceWriter(const ChromeTraceWriter&) = delete;
+    ChromeTraceWriter& operator=(const ChromeTraceWriter&) = delete;
+
+    // Create path and write the opening of the JSON, with one CPU track per core;
+    // false if it could not be created
+    bool open(const std::string& path, unsigned cores);
+
+    void cpu_slice(int core, uint32_t pid, int start, int end);
+    void io_slice(uint32_t pid, int start, int end);
+    void queues(int time, size_t ready, size_t blocked);
+
+    // Close the JSON, flush and close; false if any write failed
+    bool close();
+
+private:
+    void reserve(size_t bytes);
+    void put(const char* s, size_t len);
+    void put_uint(uint64_t v);
+    void put_time(int t) { put_uint((uint64_t)(uint32_t)t * 1000); }
+    void begin_event();
+    void flush();
+
+    int fd{-1};
+    std::vector<char> buffer;
+    size_t used{0};
+    bool first{true}; // no event written yet, so no comma before the next one
+    bool failed{false};
+};
+
+#endif
@@ -0,0 +1,68 @@
+// Author: Jimmy Ly
+// Date: October 6 2025
+//
+// Work-stealing pool for running many independent tasks of uneven size, such as
+// one simulation per burst file.
+
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs task(i) for every i in [0, count) on `threads` threads and returns once all
+// of them are done. Tasks are dealt round-robin into one deque per thread; a thread
+// works through its own deque from the front (in input order) and, once that is
+// empty, steals from the back of the others, so a few long tasks cannot leave the
+// other threads idle and owner and thief rarely contend for the same end.
+template <typename Task>
+void run_work_stealing(size_t count, unsigned threads, Task task) {
+    if (threads == 0) threads = 1;
+    if (threads > count) threads = count ? (unsigned)count : 1;
+
+    struct Queue {
+        std::mutex mu;
+        std::deque<size_t> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+    for (unsigned t = 0; t < threads; ++t) queues.emplace_back(new Queue);
+    for (size_t i = 0; i < count; ++i) queues[i % threads] -> tasks.push_back(i);
+
+    auto take = [&](unsigned self, size_t& out) {
+        {
+            Queue& own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mu);
+            if (!own.tasks.empty()) {
+                out = own.tasks.front();
+                own.tasks.pop_front();
+                return true;
+            }
+        }
+        // Nothing queued is ever added back, so one pass over the others is final
+        for (unsigned k = 1; k < threads; ++k) {
+            Queue& victim = *queues[(self + k) % threads];
+            std::lock_guard<std::mutex> lock(victim.mu);
+            if (!victim.tasks.empty()) {
+                out = victim.tasks.back();
+                victim.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            size_t i;
+            while (take(t, i)) task(i);
+        });
+    }
+    for (auto& th : pool) th.join();
+}
+
+#endif